@@ -0,0 +1,100 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace script
+{
+	//
+	// fixed size set of small integers, one bit each.
+	//
+	class BitVector
+	{
+		typedef uint64_t Word;
+		static const size_t WordBits = 64;
+
+	public:
+		BitVector() : size_(0) {}
+		explicit BitVector(size_t size) { resize(size); }
+
+		// resize to size bits, all clear.
+		void resize(size_t size) {
+			size_ = size;
+			words_.assign((size + WordBits - 1) / WordBits, 0);
+		}
+
+		size_t size() const { return size_; }
+
+		bool test(size_t idx) const {
+			return (words_[idx / WordBits] >> (idx % WordBits)) & 1;
+		}
+		void set(size_t idx) {
+			words_[idx / WordBits] |= (Word)1 << (idx % WordBits);
+		}
+		void reset(size_t idx) {
+			words_[idx / WordBits] &= ~((Word)1 << (idx % WordBits));
+		}
+
+		// this |= other, true if any bit changed.
+		bool unionWith(const BitVector &other) {
+			Word changed = 0;
+			for (size_t i = 0; i < words_.size(); ++i) {
+				Word word = words_[i] | other.words_[i];
+				changed |= word ^ words_[i];
+				words_[i] = word;
+			}
+			return changed != 0;
+		}
+
+		// this |= add & ~remove, true if any bit changed.
+		bool unionWithDifference(const BitVector &add,
+			const BitVector &remove) {
+			Word changed = 0;
+			for (size_t i = 0; i < words_.size(); ++i) {
+				Word word = words_[i] | (add.words_[i] & ~remove.words_[i]);
+				changed |= word ^ words_[i];
+				words_[i] = word;
+			}
+			return changed != 0;
+		}
+
+		// first set bit at or after idx, size() if there is none.
+		size_t findNext(size_t idx) const {
+			if (idx >= size_)
+				return size_;
+			size_t i = idx / WordBits;
+			Word word = words_[i] & (~(Word)0 << (idx % WordBits));
+			while (word == 0) {
+				if (++i == words_.size())
+					return size_;
+				word = words_[i];
+			}
+			return i * WordBits + lowestBit(word);
+		}
+
+		template <typename Func>
+		void forEach(Func func) const {
+			for (size_t idx = findNext(0); idx < size_;
+				idx = findNext(idx + 1))
+				func(idx);
+		}
+
+	private:
+		static size_t lowestBit(Word word) {
+#if defined(__GNUC__)
+			return __builtin_ctzll(word);
+#else
+			size_t bit = 0;
+			while (!(word & 1)) {
+				word >>= 1;
+				++bit;
+			}
+			return bit;
+#endif
+		}
+
+		std::vector<Word> words_;
+		size_t size_;
+	};
+}
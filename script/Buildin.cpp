@@ -1,141 +1,207 @@
-﻿#include "Buildin.h"
-
-#include <cstring>
-
-#include "VM.h"
-#include "GC.h"
-
-extern "C" Object *GlobalObjectBuffer;
-
-static inline bool IsCalable(Object self) 
-{
-	return IsFixnum(self);
-}
-
-Object Add(Object LHS, Object RHS)
-{
-	if (IsCalable(LHS) && IsCalable(RHS)) {
-		return CreateFixnum(GetFixnum(LHS) + GetFixnum(RHS));
-	}
-	return CreateNil();
-}
-
-Object Sub(Object LHS, Object RHS)
-{
-	if (IsCalable(LHS) && IsCalable(RHS)) {
-		return CreateFixnum(GetFixnum(LHS) - GetFixnum(RHS));
-	}
-	return CreateNil();
-}
-
-Object Mul(Object LHS, Object RHS)
-{
-	if (IsCalable(LHS) && IsCalable(RHS)) {
-		return CreateFixnum(GetFixnum(LHS) * GetFixnum(RHS));
-	}
-	return CreateNil();
-}
-
-Object Div(Object LHS, Object RHS)
-{
-	if (IsCalable(LHS) && IsCalable(RHS)) {
-		int right = GetFixnum(RHS);
-		if (right == 0)
-			return CreateNil();
-		return CreateFixnum(GetFixnum(LHS) / GetFixnum(RHS));
-	}
-	return CreateNil();
-}
-
-Object Great(Object LHS, Object RHS)
-{
-	return CreateFixnum(ToFixnum(LHS) > ToFixnum(RHS));
-}
-
-Object Less(Object LHS, Object RHS)
-{
-	return CreateFixnum(ToFixnum(LHS) < ToFixnum(RHS));
-}
-
-Object NotGreat(Object LHS, Object RHS)
-{
-	return CreateFixnum(ToFixnum(LHS) <= ToFixnum(RHS));
-}
-
-Object NotLess(Object LHS, Object RHS)
-{
-	return CreateFixnum(ToFixnum(LHS) >= ToFixnum(RHS));
-}
-
-Object Equal(Object LHS, Object RHS)
-{
-	if (IsString(LHS) && IsString(RHS)) {
-		return CreateFixnum(strcmp(StringGet(LHS), StringGet(RHS)) == 0);
-	}
-	return CreateFixnum(ToFixnum(LHS) == ToFixnum(RHS));
-}
-
-Object NotEqual(Object LHS, Object RHS)
-{
-	if (IsString(LHS) && IsString(RHS)) {
-		return CreateFixnum(strcmp(StringGet(LHS), StringGet(RHS)) != 0);
-	}
-	return CreateFixnum(ToFixnum(LHS) == ToFixnum(RHS));
-}
-
-Object Not(Object LHS)
-{
-	return CreateFixnum(!ToLogicValue(LHS));
-}
-
-void ProcessGlobals(void *scene)
-{
-	using script::VMFrame;
-	using script::VMScene;
-	using script::GarbageCollector;
-
-	VMScene *vmscene = static_cast<VMScene*>(scene);
-	GarbageCollector *GC = &vmscene->GC;
-	for (auto &frame : vmscene->frames) {
-		GC->processReference(&frame.params);
-		GC->processReference(&frame.registers);
-	}
-	for (auto &object : vmscene->paramsStack) {
-		GC->processReference(&object);
-	}
-	if (GlobalObjectBuffer != NULL)
-		GC->processReference(GlobalObjectBuffer);
-}
-
-void ProcessVariableReference(void *scene, Object *object)
-{
-	using script::VMScene;
-	using script::GarbageCollector;
-
-	VMScene *vmscene = static_cast<VMScene*>(scene);
-	GarbageCollector *GC = &vmscene->GC;
-	if (IsClosure(*object)) {
-		size_t hold = ClosureHold(*object);
-		Object *params = ClosureParams(*object);
-		for (size_t idx = 0; idx < hold; ++idx) {
-			GC->processReference(&(params[idx]));
-		}
-	}
-	else if (IsArray(*object)) {
-		size_t length = ArraySize(*object);
-		Object *array = ArrayPointer(*object);
-		for (size_t idx = 0; idx < length; ++idx) {
-			GC->processReference(&array[idx]);
-		}
-	}
-	else if (IsHash(*object)) {
-		GC->processReference(HashNodeListGet(*object));
-	}
-	else if (IsHashNodeList(*object)) {
-		size_t size = NodeListElementCapacity(*object);
-		HashNode *nodes = HashNodeListElement(*object);
-		for (size_t idx = 0; idx < size; ++idx) {
-			GC->processReference(&nodes[idx].value);
-		}
-	}
-}
+﻿#include "Buildin.h"
+
+#include <cstring>
+
+#include "VM.h"
+#include "GC.h"
+
+extern "C" Object *GlobalObjectBuffer;
+extern "C" size_t GlobalObjectBufferSize;
+
+static inline bool IsCalable(Object self) 
+{
+	return IsNumber(self);
+}
+
+// fixnum results which don't fit 62 bits become reals.
+static inline Object CreateNumber(intptr_t value)
+{
+	if (FixnumFits(value))
+		return CreateFixnum(value);
+	return CreateReal((double)value);
+}
+
+Object Add(Object LHS, Object RHS)
+{
+	if (IsFixnum(LHS) && IsFixnum(RHS)) {
+		return CreateNumber(GetFixnum(LHS) + GetFixnum(RHS));
+	}
+	if (IsCalable(LHS) && IsCalable(RHS)) {
+		return CreateReal(ToReal(LHS) + ToReal(RHS));
+	}
+	if (IsString(LHS) && IsString(RHS)) {
+		return StringConcat(LHS, RHS);
+	}
+	return CreateNil();
+}
+
+Object Sub(Object LHS, Object RHS)
+{
+	if (IsFixnum(LHS) && IsFixnum(RHS)) {
+		return CreateNumber(GetFixnum(LHS) - GetFixnum(RHS));
+	}
+	if (IsCalable(LHS) && IsCalable(RHS)) {
+		return CreateReal(ToReal(LHS) - ToReal(RHS));
+	}
+	return CreateNil();
+}
+
+Object Mul(Object LHS, Object RHS)
+{
+	if (IsFixnum(LHS) && IsFixnum(RHS)) {
+		intptr_t left = GetFixnum(LHS), right = GetFixnum(RHS);
+#if defined(__GNUC__)
+		intptr_t product;
+		if (!__builtin_mul_overflow(left, right, &product))
+			return CreateNumber(product);
+#else
+		// exact when the rounded product is far enough from overflow.
+		double estimate = (double)left * (double)right;
+		if (estimate < 1152921504606846976.0 
+			&& estimate > -1152921504606846976.0)
+			return CreateFixnum(left * right);
+#endif
+		return CreateReal((double)left * (double)right);
+	}
+	if (IsCalable(LHS) && IsCalable(RHS)) {
+		return CreateReal(ToReal(LHS) * ToReal(RHS));
+	}
+	return CreateNil();
+}
+
+Object Div(Object LHS, Object RHS)
+{
+	if (IsFixnum(LHS) && IsFixnum(RHS)) {
+		intptr_t right = GetFixnum(RHS);
+		if (right == 0)
+			return CreateNil();
+		return CreateNumber(GetFixnum(LHS) / right);
+	}
+	if (IsCalable(LHS) && IsCalable(RHS)) {
+		return CreateReal(ToReal(LHS) / ToReal(RHS));
+	}
+	return CreateNil();
+}
+
+// ints compare exactly, a real operand compares both as double.
+static inline int Compare(Object LHS, Object RHS)
+{
+	if (IsFixnum(LHS) && IsFixnum(RHS)) {
+		intptr_t left = GetFixnum(LHS), right = GetFixnum(RHS);
+		return (left > right) - (left < right);
+	}
+	if (IsCalable(LHS) && IsCalable(RHS)) {
+		double left = ToReal(LHS), right = ToReal(RHS);
+		if (left != left || right != right)
+			return 2;	// unordered
+		return (left > right) - (left < right);
+	}
+	intptr_t left = ToFixnum(LHS), right = ToFixnum(RHS);
+	return (left > right) - (left < right);
+}
+
+Object Great(Object LHS, Object RHS)
+{
+	return CreateFixnum(Compare(LHS, RHS) == 1);
+}
+
+Object Less(Object LHS, Object RHS)
+{
+	return CreateFixnum(Compare(LHS, RHS) == -1);
+}
+
+Object NotGreat(Object LHS, Object RHS)
+{
+	int result = Compare(LHS, RHS);
+	return CreateFixnum(result == -1 || result == 0);
+}
+
+Object NotLess(Object LHS, Object RHS)
+{
+	int result = Compare(LHS, RHS);
+	return CreateFixnum(result == 1 || result == 0);
+}
+
+static bool IsEqual(Object LHS, Object RHS)
+{
+	if (IsReal(LHS) || IsReal(RHS))
+		return Compare(LHS, RHS) == 0;
+	// interned literals compare by identity.
+	if (LHS == RHS)
+		return true;
+	if (IsString(LHS) && IsString(RHS)) {
+		return StringSize(LHS) == StringSize(RHS)
+			&& memcmp(StringGet(LHS), StringGet(RHS), StringSize(LHS)) == 0;
+	}
+	return ToFixnum(LHS) == ToFixnum(RHS);
+}
+
+Object Equal(Object LHS, Object RHS)
+{
+	return CreateFixnum(IsEqual(LHS, RHS));
+}
+
+Object NotEqual(Object LHS, Object RHS)
+{
+	return CreateFixnum(!IsEqual(LHS, RHS));
+}
+
+Object Not(Object LHS)
+{
+	return CreateFixnum(!ToLogicValue(LHS));
+}
+
+void ProcessGlobals(void *scene)
+{
+	using script::VMFrame;
+	using script::VMScene;
+	using script::GarbageCollector;
+
+	VMScene *vmscene = static_cast<VMScene*>(scene);
+	GarbageCollector *GC = &vmscene->GC;
+	for (auto &object : vmscene->stack) {
+		GC->processReference(&object);
+	}
+	if (GlobalObjectBuffer != NULL) {
+		for (size_t idx = 0; idx < GlobalObjectBufferSize; ++idx)
+			GC->processReference(&GlobalObjectBuffer[idx]);
+	}
+}
+
+void ProcessVariableReference(void *scene, Object *object)
+{
+	using script::VMScene;
+	using script::GarbageCollector;
+
+	VMScene *vmscene = static_cast<VMScene*>(scene);
+	GarbageCollector *GC = &vmscene->GC;
+	if (IsClosure(*object)) {
+		size_t hold = ClosureHold(*object);
+		Object *params = ClosureParams(*object);
+		for (size_t idx = 0; idx < hold; ++idx) {
+			GC->processReference(&(params[idx]));
+		}
+	}
+	else if (IsArray(*object)) {
+		size_t length = ArraySize(*object);
+		Object *array = ArrayPointer(*object);
+		for (size_t idx = 0; idx < length; ++idx) {
+			GC->processReference(&array[idx]);
+		}
+	}
+	else if (IsStringSlice(*object)) {
+		GC->processReference(StringSliceBaseGet(*object));
+	}
+	else if (IsHash(*object)) {
+		GC->processReference(HashNodeListGet(*object));
+		GC->processReference(HashArrayPartGet(*object));
+	}
+	else if (IsHashNodeList(*object)) {
+		size_t size = NodeListElementCapacity(*object);
+		HashNode *nodes = HashNodeListElement(*object);
+		for (size_t idx = 0; idx < size; ++idx) {
+			GC->processReference(&nodes[idx].key);
+			GC->processReference(&nodes[idx].value);
+		}
+	}
+}
@@ -1,471 +1,524 @@
-#include "CFG.h"
-
-#include <map>
-#include <queue>
-#include <list>
-#include <functional>
-#include <algorithm>
-#include <cassert>
-#include <sstream>
-
-#include "Value.h"
-#include "Instruction.h"
-#include "IRContext.h"
-
-namespace script
-{
-    BasicBlock::~BasicBlock()
-    {
-		while (!instrs_.empty())
-		{
-			instrs_.front()->erase_from_parent();
-		}
-    }
-
-    BasicBlock * CFG::createBasicBlock(const std::string &name)
-    {
-        numBlockIDs_++;
-        BasicBlock *temp = new BasicBlock(name);
-        blocks_.push_back(temp);
-        return temp;
-    }
-
-    void CFG::setEntry(BasicBlock * entry)
-    {
-        assert(entry != nullptr);
-        start_ = entry;
-    }
-
-    void CFG::setEnd(BasicBlock * end)
-    {
-        assert(end != nullptr);
-        end_ = end;
-    }
-
-    BasicBlock * CFG::getEntryBlock()
-    {
-        return start_;
-    }
-
-    void CFG::sealOthersBlock()
-    {
-        for (auto *block : blocks_)
-            sealBlock(block);
-
-		// it mean that no info need anymore.
-		currentDef_.clear();
-		assert(incompletePhis_.size() == 0);
-		sealedBlock_.clear();
-		phiCounts_.clear();
-    }
-
-    void CFG::sealBlock(BasicBlock * block)
-    {   
-        assert(block != nullptr);
-        if (sealedBlock_.count(block) != 0)
-            return;
-        
-        auto &block2Phi = incompletePhis_[block];
-        for (auto &b2p : block2Phi)
-        {
-            addPhiOperands(b2p.first, (Phi*)b2p.second);
-        }
-		incompletePhis_.erase(block);
-        sealedBlock_.insert(block);
-    }
-
-    void CFG::saveVariableDef(std::string name, 
-        BasicBlock * block, Value * value)
-    {
-        assert(block != nullptr && value != nullptr);
-		auto &target = currentDef_[name][block];
-		target = value;
-    }
-
-    Value * CFG::readVariableDef(std::string name, BasicBlock * block)
-    {
-        assert(block != nullptr);
-        auto &def = currentDef_[name];
-        if (def.find(block) != def.end())
-            return def[block];
-        return readVariableRecurisive(name, block);
-    }
-
-    std::string CFG::phiName(const std::string & name)
-    {
-        std::stringstream stream;
-        stream << name << '.' << phiCounts_[name]++;
-        std::string tmp;
-        stream >> tmp;
-        return tmp;
-    }
-
-    Value * CFG::readVariableRecurisive(std::string name, BasicBlock * block)
-    {
-        assert(block != nullptr);
-        Value *val = nullptr;
-        if (sealedBlock_.find(block) == sealedBlock_.end())
-        {
-            // incomplete CFGs.
-            val = IRContext::createAtBegin<Phi>(block, phiName(name));
-            incompletePhis_[block][name] = val;
-        }
-        else if (block->numOfPrecursors() == 1)
-        {
-            // Optimize the common case of one predecessor, no Phi needed.
-            val = readVariableDef(name, block->precursor(0));
-        }
-        else
-        {
-            // Break potential cycles with operandless Phi
-            val = IRContext::createAtBegin<Phi>(block, phiName(name));
-            saveVariableDef(name, block, val);
-            val = addPhiOperands(name, (Phi*)val);
-        }
-        saveVariableDef(name, block, val);
-        return val;
-    }
-
-    Value * CFG::addPhiOperands(std::string name, Phi * phi)
-    {
-        // Determine operands from predecessors
-        BasicBlock *phiParent = phi->get_parent();
-        for (auto i = phiParent->precursor_begin(),
-            e = phiParent->precursor_end();
-            i != e; ++i)
-        {
-			Value *val = readVariableDef(name, *i);
-			if (val->is_undef())
-				// igonre all undef value from unreachbale precursor
-				continue;	
-            phi->appendOperand(val);
-        }
-        return tryRemoveTrivialPhi(name, phi);
-    }
-
-    Value * CFG::tryRemoveTrivialPhi(const std::string &name, Phi * phi)
-    {
-        Value *same = nullptr;
-        for (auto beg = phi->op_begin(); beg != phi->op_end(); beg++)
-        {
-            Value *op = beg->get_value();
-            if (op == same || op == phi)
-                // Unique value or self−reference
-                continue;
-            if (same != nullptr)
-                // The phi merges at least two values : not trivial
-                return phi;
-            same = op;
-        }
-        if (same == nullptr)
-            same = IRContext::create<Undef>();
-
-		// update variable def set.
-		BasicBlock *parent = phi->get_parent();
-		saveVariableDef(name, parent, same);
-
-        // try all users except the phi itself.
-        // Try to recursively remove all phi users, 
-        // which might have become trivial, now just save it
-		std::set<Phi*> needTryPhiNode;
-        for (auto iter = phi->use_begin(); iter != phi->use_end(); ++iter)
-        {   
-            Instruction *instr = static_cast<Instruction*>(
-                (*iter)->get_user());
-			if (instr != phi && instr->is_phi_node())
-				needTryPhiNode.insert(static_cast<Phi*>(instr));
-        }
-
-        // Reroute all uses of phi to same and remove phi
-		phi->replace_all_uses_with(same);
-
-		// prevent cycle release.
-		phi->drop_all_references();
-
-		// After replace all use of phi, try to remove others trivial node
-		for (auto *P : needTryPhiNode) {
-			tryRemoveTrivialPhi(name, P);
-		}
-
-		phi->erase_from_parent();
-
-		// FIXME: 
-		same = readVariableDef(name, parent);
-
-		// update reference
-		auto &def = currentDef_[name];
-		for (auto &B2V : def) {
-			if (B2V.second == phi) {
-				saveVariableDef(name, B2V.first, same);
-			}
-		}
-
-        return same;
-    }
-
-	void CFG::computeBlockOrder()
-	{
-		std::list<BasicBlock*> finalBlockOrder;
-		std::priority_queue<BasicBlock*, 
-			std::vector<BasicBlock*>, BlockOrderCmp> queue;
-
-		loopDetection();
-
-		queue.push(this->getEntryBlock());
-		while (!queue.empty()) {
-			BasicBlock *block = queue.top(); 
-			queue.pop();
-
-			finalBlockOrder.push_back(block);
-			for (auto *succ : block->successors_) {
-				succ->incomingForwardBranches_ -= 1;
-				if (succ->incomingForwardBranches_ == 0) {
-					queue.push(succ);
-				}
-			}
-		}
-		blocks_.swap(finalBlockOrder);
-		numberOperations();
-	}
-
-	void CFG::loopDetection()
-	{
-		B2B loopEndToHead;
-		std::set<BasicBlock*> visited;
-		BasicBlock *entry = this->getEntryBlock();
-		this->numLoopIndex_ = 0;
-		this->tryToDetect(loopEndToHead, entry);
-		for (auto pair : loopEndToHead) {
-			visited.clear();
-			tryToAssignIndex(
-				pair.second->loopIndex_,
-				pair.first, pair.second, visited);
-		}
-	}
-
-	void CFG::numberOperations()
-	{
-		unsigned nextID = 0;
-		for (auto *block : this->blocks_) {
-			block->start_ = nextID;
-			for (auto *instr : block->instrs_) {
-				instr->setID(nextID);
-				nextID += 2;
-			}
-			block->end_ = nextID;
-		}
-	}
-
-	void CFG::tryToDetect(B2B & set, BasicBlock * block)
-	{
-		assert(block);
-
-		if (block->state_ & BasicBlock::Visited)
-			return;
-
-		// init
-		block->loopDepth_ = 0;
-		block->loopIndex_ = -1;
-		block->incomingForwardBranches_ = block->precursors_.size();
-
-		block->state_ |= BasicBlock::Visited;
-		block->state_ |= BasicBlock::Active;
-		for (auto *succ : block->successors_) {
-			if (succ->state_ & BasicBlock::Active) {
-				set.insert({ block, succ });
-				succ->loopIndex_ = this->numLoopIndex_++;
-				succ->loopDepth_ = 1;
-				succ->incomingForwardBranches_ -= 1;
-				continue;
-			}
-			tryToDetect(set, succ);
-		}
-		block->state_ &= ~BasicBlock::Active;
-	}
-
-	void CFG::tryToAssignIndex(
-		int index, 
-		BasicBlock * current, 
-		BasicBlock * target,
-		std::set<BasicBlock*> &visited)
-	{
-		if (visited.count(current) || current == target)
-			return;
-		
-		++current->loopDepth_;
-		if (current->loopIndex_ < 0)
-			current->loopIndex_ = index;
-		else
-			current->loopIndex_ = std::min(current->loopIndex_, index);
-	}
-
-    void CFG::erase(BasicBlock *block) 
-    {
-        for (auto P = block->phi_begin(); P != block->phi_end(); ++P) 
-        {
-            Phi *phi = *P;
-            phi->drop_all_references();
-        }
-
-		for (auto succ = block->successor_begin();
-			succ != block->successor_end();
-			++succ) {
-			BasicBlock *SBB = *succ;
-			auto &precursors = SBB->precursors_;
-			auto next = precursors.begin(), iter = next;
-			while (iter != precursors.end()) {
-				if (!(*iter == block)) {
-					*next = *iter;
-					++next;
-				}
-				++iter;
-			}
-			precursors.resize(next - precursors.begin());
-		}
-        
-        blocks_.remove(block);
-        delete block;
-    }
-
-    CFG::CFG()
-        : start_(nullptr), end_(nullptr)
-    {
-    }
-
-    CFG::~CFG()
-    {
-        for (auto &i : blocks_)
-        {
-            delete i;
-            i = nullptr;
-        }
-    }
-
-    void BasicBlock::addPrecursor(BasicBlock * block)
-    {
-        precursors_.push_back(block);
-    }
-
-    void BasicBlock::addSuccessor(BasicBlock * block)
-    {
-        successors_.push_back(block);
-    }
-
-    BasicBlock * BasicBlock::precursor(int idx)
-    {
-        if (idx < numOfPrecursors())
-            return precursors_[idx];
-        return nullptr;
-    }
-
-    BasicBlock * BasicBlock::successor(int idx)
-    {
-        if (idx < numOfSuccessors())
-            return successors_[idx];
-        return nullptr;
-    }
-
-	void BasicBlock::successor_replace(
-		BasicBlock *from, BasicBlock * block)
-	{
-		auto pos = std::find(successors_.begin(), successors_.end(), from);
-		if (pos == successors_.end())
-			successors_.push_back(block);
-		else
-			*pos = block;
-	}
-
-	void BasicBlock::insert(instr_iterator iter, Instruction * instr)
-	{
-		assert(instr != nullptr);
-		instrs_.insert(iter, instr);
-        tryInsertPhiNode(instr);
-	}
-
-	void BasicBlock::push_back(Instruction * instr)
-    {
-        assert(instr != nullptr);
-        instrs_.push_back(instr);
-        tryInsertPhiNode(instr);
-    }
-
-    void BasicBlock::push_front(Instruction * instr)
-    {
-        assert(instr != nullptr);
-        instrs_.push_front(instr);
-        tryInsertPhiNode(instr);
-    }
-
-    void BasicBlock::pop_back()
-    {
-        tryRemovePhiNode(instrs_.back());
-        instrs_.pop_back();
-    }
-
-    void BasicBlock::pop_front()
-    {
-        tryRemovePhiNode(instrs_.front());
-        instrs_.pop_front();
-    }
-
-    bool BasicBlock::contains(Instruction *instr)
-    {
-        for (auto *I : instrs_)
-            if (I == instr)
-                return true;
-        return false;
-    }
-
-    void BasicBlock::erase(Instruction * instr)
-    {
-        tryRemovePhiNode(instr);
-        instrs_.remove(instr);
-        delete instr;
-    }
-
-    void BasicBlock::remove(Instruction * instr)
-    {
-        tryRemovePhiNode(instr);
-        instrs_.remove(instr);
-    }
-
-    void BasicBlock::replaceInstrWith(Instruction *from, Instruction *to)
-    {
-        for (auto *& elem : instrs_)
-        {
-            if (elem == from) {
-                elem = to;
-                tryRemovePhiNode(elem);
-                tryInsertPhiNode(to);
-            }
-        }
-    }
-
-    void BasicBlock::tryRemovePhiNode(Instruction * instr)
-    {
-        if (instr->is_phi_node()) {
-            removePhiNodeRecord(static_cast<Phi*>(instr));
-        }
-    }
-
-    void BasicBlock::tryInsertPhiNode(Instruction * instr)
-    {
-        if (instr->is_phi_node()) {
-            recordPhiNode(static_cast<Phi*>(instr));
-        }
-    }
-
-    void BasicBlock::removePhiNodeRecord(Phi * phi)
-	{
-		phiNodes_.remove(phi);
-	}
-	
-	void BasicBlock::recordPhiNode(Phi * phi)
-	{
-		for (auto *p : phiNodes_)
-			if (p == phi)
-				return;
-		phiNodes_.push_back(phi);
-	}
-}
-
+#include "CFG.h"
+
+#include <map>
+#include <queue>
+#include <list>
+#include <functional>
+#include <algorithm>
+#include <cassert>
+#include <sstream>
+
+#include "Value.h"
+#include "Instruction.h"
+#include "IRContext.h"
+
+namespace script
+{
+    BasicBlock::~BasicBlock()
+    {
+		while (!instrs_.empty())
+		{
+			instrs_.front()->erase_from_parent();
+		}
+    }
+
+    BasicBlock * CFG::createBasicBlock(const std::string &name)
+    {
+        numBlockIDs_++;
+        BasicBlock *temp = new BasicBlock(name);
+        blocks_.push_back(temp);
+        return temp;
+    }
+
+    void CFG::setEntry(BasicBlock * entry)
+    {
+        assert(entry != nullptr);
+        start_ = entry;
+    }
+
+    void CFG::setEnd(BasicBlock * end)
+    {
+        assert(end != nullptr);
+        end_ = end;
+    }
+
+    BasicBlock * CFG::getEntryBlock()
+    {
+        return start_;
+    }
+
+    void CFG::sealOthersBlock()
+    {
+        for (auto *block : blocks_)
+            sealBlock(block);
+
+		// it mean that no info need anymore.
+		currentDef_.clear();
+		assert(incompletePhis_.size() == 0);
+		sealedBlock_.clear();
+		phiCounts_.clear();
+    }
+
+    void CFG::sealBlock(BasicBlock * block)
+    {   
+        assert(block != nullptr);
+        if (sealedBlock_.count(block) != 0)
+            return;
+        
+        auto &block2Phi = incompletePhis_[block];
+        for (auto &b2p : block2Phi)
+        {
+            addPhiOperands(b2p.first, (Phi*)b2p.second);
+        }
+		incompletePhis_.erase(block);
+        sealedBlock_.insert(block);
+    }
+
+    void CFG::saveVariableDef(std::string name, 
+        BasicBlock * block, Value * value)
+    {
+        assert(block != nullptr && value != nullptr);
+		auto &target = currentDef_[name][block];
+		target = value;
+    }
+
+    Value * CFG::readVariableDef(std::string name, BasicBlock * block)
+    {
+        assert(block != nullptr);
+        auto &def = currentDef_[name];
+        if (def.find(block) != def.end())
+            return def[block];
+        return readVariableRecurisive(name, block);
+    }
+
+    std::string CFG::phiName(const std::string & name)
+    {
+        std::stringstream stream;
+        stream << name << '.' << phiCounts_[name]++;
+        std::string tmp;
+        stream >> tmp;
+        return tmp;
+    }
+
+    Value * CFG::readVariableRecurisive(std::string name, BasicBlock * block)
+    {
+        assert(block != nullptr);
+        Value *val = nullptr;
+        if (sealedBlock_.find(block) == sealedBlock_.end())
+        {
+            // incomplete CFGs.
+            val = IRContext::createAtBegin<Phi>(block, phiName(name));
+            incompletePhis_[block][name] = val;
+        }
+        else if (block->numOfPrecursors() == 1)
+        {
+            // Optimize the common case of one predecessor, no Phi needed.
+            val = readVariableDef(name, block->precursor(0));
+        }
+        else
+        {
+            // Break potential cycles with operandless Phi
+            val = IRContext::createAtBegin<Phi>(block, phiName(name));
+            saveVariableDef(name, block, val);
+            val = addPhiOperands(name, (Phi*)val);
+        }
+        saveVariableDef(name, block, val);
+        return val;
+    }
+
+    Value * CFG::addPhiOperands(std::string name, Phi * phi)
+    {
+        // Determine operands from predecessors
+        BasicBlock *phiParent = phi->get_parent();
+        for (auto i = phiParent->precursor_begin(),
+            e = phiParent->precursor_end();
+            i != e; ++i)
+        {
+			Value *val = readVariableDef(name, *i);
+			if (val->is_undef())
+				// igonre all undef value from unreachbale precursor
+				continue;	
+            phi->appendOperand(val, *i);
+        }
+        return tryRemoveTrivialPhi(name, phi);
+    }
+
+    Value * CFG::tryRemoveTrivialPhi(const std::string &name, Phi * phi)
+    {
+        Value *same = nullptr;
+        for (auto beg = phi->op_begin(); beg != phi->op_end(); beg++)
+        {
+            Value *op = beg->get_value();
+            if (op == same || op == phi)
+                // Unique value or self−reference
+                continue;
+            if (same != nullptr)
+                // The phi merges at least two values : not trivial
+                return phi;
+            same = op;
+        }
+        if (same == nullptr)
+            same = IRContext::create<Undef>();
+
+        // try all users except the phi itself.
+        // Try to recursively remove all phi users, 
+        // which might have become trivial, now just save it
+		std::set<Phi*> needTryPhiNode;
+        for (auto iter = phi->use_begin(); iter != phi->use_end(); ++iter)
+        {   
+            Instruction *instr = static_cast<Instruction*>(
+                (*iter)->get_user());
+			if (instr != phi && instr->is_phi_node())
+				needTryPhiNode.insert(static_cast<Phi*>(instr));
+        }
+
+        // Reroute all uses of phi to same and remove phi
+		phi->replace_all_uses_with(same);
+
+		// prevent cycle release.
+		phi->drop_all_references();
+
+		// blocks which still see the phi see same now, a later
+		// definition in the phi's own block must survive.
+		auto &def = currentDef_[name];
+		for (auto &B2V : def) {
+			if (B2V.second == phi) {
+				saveVariableDef(name, B2V.first, same);
+			}
+		}
+
+		// After replace all use of phi, try to remove others trivial node,
+		// same itself may be one of them.
+		for (auto *P : needTryPhiNode) {
+			Value *value = tryRemoveTrivialPhi(name, P);
+			if (P == same)
+				same = value;
+		}
+
+		phi->erase_from_parent();
+
+        return same;
+    }
+
+	void CFG::computeBlockOrder()
+	{
+		std::list<BasicBlock*> finalBlockOrder;
+		std::priority_queue<BasicBlock*, 
+			std::vector<BasicBlock*>, BlockOrderCmp> queue;
+
+		loopDetection();
+
+		queue.push(this->getEntryBlock());
+		while (!queue.empty()) {
+			BasicBlock *block = queue.top(); 
+			queue.pop();
+
+			finalBlockOrder.push_back(block);
+			for (auto *succ : block->successors_) {
+				succ->incomingForwardBranches_ -= 1;
+				if (succ->incomingForwardBranches_ == 0) {
+					queue.push(succ);
+				}
+			}
+		}
+		blocks_.swap(finalBlockOrder);
+		numberOperations();
+	}
+
+	BasicBlock *CFG::splitEdge(BasicBlock *from, BasicBlock *to)
+	{
+		BasicBlock *BB = createBasicBlock(
+			from->getBlockName() + "-" + to->getBlockName());
+		Goto *go2 = IRContext::create<Goto>(to);
+		BB->push_back(go2);
+		go2->set_parent(BB);
+		BB->addPrecursor(from);
+		BB->addSuccessor(to);
+
+		auto pre = std::find(to->precursors_.begin(), 
+			to->precursors_.end(), from);
+		assert(pre != to->precursors_.end());
+		*pre = BB;
+
+		from->successor_replace(to, BB);
+		for (auto P = to->phi_begin(); P != to->phi_end(); ++P)
+			(*P)->replaceIncomingBlock(from, BB);
+		if (from->back()->is_goto()) {
+			Goto *GT = static_cast<Goto*>(from->back());
+			GT->setTarget(BB);
+		}
+		else if (from->back()->is_branch()) {
+			Branch *branch = static_cast<Branch*>(from->back());
+			if (branch->then() == to)
+				branch->setThen(BB);
+			else
+				branch->setElse(BB);
+		}
+		else {
+			assert(0 && "impossible");
+		}
+		return BB;
+	}
+
+	void CFG::loopDetection()
+	{
+		B2B loopEndToHead;
+		std::set<BasicBlock*> visited;
+		BasicBlock *entry = this->getEntryBlock();
+		this->numLoopIndex_ = 0;
+		// Forward branches are counted while walking from entry, so 
+		// edges from unreachable blocks never hold a block back.
+		for (auto *block : this->blocks_) {
+			block->state_ = BasicBlock::Unvisit;
+			block->incomingForwardBranches_ = 0;
+		}
+		this->tryToDetect(loopEndToHead, entry);
+		for (auto pair : loopEndToHead) {
+			visited.clear();
+			tryToAssignIndex(
+				pair.second->loopIndex_,
+				pair.first, pair.second, visited);
+		}
+	}
+
+	void CFG::numberOperations()
+	{
+		unsigned nextID = 0;
+		for (auto *block : this->blocks_) {
+			block->start_ = nextID;
+			for (auto *instr : block->instrs_) {
+				instr->setID(nextID);
+				nextID += 2;
+			}
+			block->end_ = nextID;
+		}
+	}
+
+	void CFG::tryToDetect(B2B & set, BasicBlock * block)
+	{
+		assert(block);
+
+		if (block->state_ & BasicBlock::Visited)
+			return;
+
+		// init
+		block->loopDepth_ = 0;
+		block->loopIndex_ = -1;
+
+		block->state_ |= BasicBlock::Visited;
+		block->state_ |= BasicBlock::Active;
+		for (auto *succ : block->successors_) {
+			if (succ->state_ & BasicBlock::Active) {
+				set.insert({ block, succ });
+				succ->loopIndex_ = this->numLoopIndex_++;
+				succ->loopDepth_ = 1;
+				continue;
+			}
+			succ->incomingForwardBranches_ += 1;
+			tryToDetect(set, succ);
+		}
+		block->state_ &= ~BasicBlock::Active;
+	}
+
+	void CFG::tryToAssignIndex(
+		int index, 
+		BasicBlock * current, 
+		BasicBlock * target,
+		std::set<BasicBlock*> &visited)
+	{
+		if (visited.count(current) || current == target)
+			return;
+		
+		++current->loopDepth_;
+		if (current->loopIndex_ < 0)
+			current->loopIndex_ = index;
+		else
+			current->loopIndex_ = std::min(current->loopIndex_, index);
+	}
+
+    void CFG::erase(BasicBlock *block) 
+    {
+        for (auto P = block->phi_begin(); P != block->phi_end(); ++P) 
+        {
+            Phi *phi = *P;
+            phi->drop_all_references();
+        }
+
+		for (auto succ = block->successor_begin();
+			succ != block->successor_end();
+			++succ) {
+			BasicBlock *SBB = *succ;
+			for (auto P = SBB->phi_begin(); P != SBB->phi_end(); ++P)
+				(*P)->removeIncomingBlock(block);
+			auto &precursors = SBB->precursors_;
+			auto next = precursors.begin(), iter = next;
+			while (iter != precursors.end()) {
+				if (!(*iter == block)) {
+					*next = *iter;
+					++next;
+				}
+				++iter;
+			}
+			precursors.resize(next - precursors.begin());
+		}
+        
+        blocks_.remove(block);
+        delete block;
+    }
+
+    CFG::CFG()
+        : start_(nullptr), end_(nullptr)
+    {
+    }
+
+    CFG::~CFG()
+    {
+        for (auto &i : blocks_)
+        {
+            delete i;
+            i = nullptr;
+        }
+    }
+
+    void BasicBlock::addPrecursor(BasicBlock * block)
+    {
+        precursors_.push_back(block);
+    }
+
+    void BasicBlock::addSuccessor(BasicBlock * block)
+    {
+        successors_.push_back(block);
+    }
+
+    BasicBlock * BasicBlock::precursor(int idx)
+    {
+        if (idx < numOfPrecursors())
+            return precursors_[idx];
+        return nullptr;
+    }
+
+    BasicBlock * BasicBlock::successor(int idx)
+    {
+        if (idx < numOfSuccessors())
+            return successors_[idx];
+        return nullptr;
+    }
+
+	void BasicBlock::successor_replace(
+		BasicBlock *from, BasicBlock * block)
+	{
+		auto pos = std::find(successors_.begin(), successors_.end(), from);
+		if (pos == successors_.end())
+			successors_.push_back(block);
+		else
+			*pos = block;
+	}
+
+	void BasicBlock::successor_remove(BasicBlock *block)
+	{
+		auto pos = std::find(successors_.begin(), successors_.end(), block);
+		if (pos != successors_.end())
+			successors_.erase(pos);
+	}
+
+	void BasicBlock::precursor_remove(BasicBlock *block)
+	{
+		auto pos = std::find(precursors_.begin(), precursors_.end(), block);
+		if (pos != precursors_.end())
+			precursors_.erase(pos);
+	}
+
+	void BasicBlock::insert(instr_iterator iter, Instruction * instr)
+	{
+		assert(instr != nullptr);
+		instrs_.insert(iter, instr);
+        tryInsertPhiNode(instr);
+	}
+
+	void BasicBlock::push_back(Instruction * instr)
+    {
+        assert(instr != nullptr);
+        instrs_.push_back(instr);
+        tryInsertPhiNode(instr);
+    }
+
+    void BasicBlock::push_front(Instruction * instr)
+    {
+        assert(instr != nullptr);
+        instrs_.push_front(instr);
+        tryInsertPhiNode(instr);
+    }
+
+    void BasicBlock::pop_back()
+    {
+        tryRemovePhiNode(instrs_.back());
+        instrs_.pop_back();
+    }
+
+    void BasicBlock::pop_front()
+    {
+        tryRemovePhiNode(instrs_.front());
+        instrs_.pop_front();
+    }
+
+    bool BasicBlock::contains(Instruction *instr)
+    {
+        for (auto *I : instrs_)
+            if (I == instr)
+                return true;
+        return false;
+    }
+
+    void BasicBlock::erase(Instruction * instr)
+    {
+        tryRemovePhiNode(instr);
+        instrs_.remove(instr);
+        delete instr;
+    }
+
+    void BasicBlock::remove(Instruction * instr)
+    {
+        tryRemovePhiNode(instr);
+        instrs_.remove(instr);
+    }
+
+    void BasicBlock::replaceInstrWith(Instruction *from, Instruction *to)
+    {
+        for (auto *& elem : instrs_)
+        {
+            if (elem == from) {
+                elem = to;
+                tryRemovePhiNode(elem);
+                tryInsertPhiNode(to);
+            }
+        }
+    }
+
+    void BasicBlock::tryRemovePhiNode(Instruction * instr)
+    {
+        if (instr->is_phi_node()) {
+            removePhiNodeRecord(static_cast<Phi*>(instr));
+        }
+    }
+
+    void BasicBlock::tryInsertPhiNode(Instruction * instr)
+    {
+        if (instr->is_phi_node()) {
+            recordPhiNode(static_cast<Phi*>(instr));
+        }
+    }
+
+    void BasicBlock::removePhiNodeRecord(Phi * phi)
+	{
+		phiNodes_.remove(phi);
+	}
+	
+	void BasicBlock::recordPhiNode(Phi * phi)
+	{
+		for (auto *p : phiNodes_)
+			if (p == phi)
+				return;
+		phiNodes_.push_back(phi);
+	}
+}
+
@@ -1,26 +1,26 @@
-#pragma once
-
-#include "DiagnosisConsumer.h"
-#include "driver.h"
-
-namespace script
-{
-    class CompilerInstance
-    {
-    public:
-
-        DiagnosisConsumer &getDiagnosisConsumer()
-        {
-            return diagConsumer_;
-        }
-
-        Driver &getDriver()
-        {
-            return driver_;
-        }
-
-    private:
-        Driver driver_;
-        DiagnosisConsumer diagConsumer_;
-    };
+#pragma once
+
+#include "DiagnosisConsumer.h"
+#include "driver.h"
+
+namespace script
+{
+    class CompilerInstance
+    {
+    public:
+
+        DiagnosisConsumer &getDiagnosisConsumer()
+        {
+            return diagConsumer_;
+        }
+
+        Driver &getDriver()
+        {
+            return driver_;
+        }
+
+    private:
+        Driver driver_;
+        DiagnosisConsumer diagConsumer_;
+    };
 }
\ No newline at end of file
@@ -0,0 +1,480 @@
+#include "ConstantPropagation.h"
+
+#include <cstring>
+#include <cassert>
+#include <algorithm>
+
+#include "CFG.h"
+#include "IRModule.h"
+#include "IRContext.h"
+#include "Instruction.h"
+#include "Runtime.h"
+
+namespace script
+{
+namespace {
+	// booleans and characters are fixnums in the VM.
+	bool isIntLike(unsigned type)
+	{
+		return type == Constant::Integer
+			|| type == Constant::Boolean
+			|| type == Constant::Character;
+	}
+
+	bool isNumber(unsigned type)
+	{
+		return isIntLike(type) || type == Constant::Float;
+	}
+}
+
+	bool ConstantPropagation::LatticeValue::operator == (
+		const LatticeValue &rhs) const
+	{
+		if (state != rhs.state)
+			return false;
+		if (state != Const)
+			return true;
+		if (type != rhs.type)
+			return false;
+		if (isIntLike(type))
+			return num == rhs.num;
+		if (type == Constant::Float)
+			return memcmp(&fnum, &rhs.fnum, sizeof(fnum)) == 0;
+		if (type == Constant::String)
+			return str == rhs.str;
+		return true;
+	}
+
+    void ConstantPropagation::runOnFunction(IRFunction *func)
+    {
+        assert(func);
+		lattice.clear();
+		executableBlocks.clear();
+		executableEdges.clear();
+
+		solve(func);
+		rewriteFunction(func);
+    }
+
+	void ConstantPropagation::solve(IRFunction *func)
+	{
+		BasicBlock *entry = func->getEntryBlock();
+		executableBlocks.insert(entry);
+		blockWorklist.push_back(entry);
+
+		while (!blockWorklist.empty() || !instrWorklist.empty()) {
+			while (!instrWorklist.empty()) {
+				Instruction *instr = instrWorklist.back();
+				instrWorklist.pop_back();
+				if (executableBlocks.count(instr->get_parent()))
+					visitInstruction(instr);
+			}
+
+			while (!blockWorklist.empty()) {
+				BasicBlock *block = blockWorklist.back();
+				blockWorklist.pop_back();
+				for (auto iter = block->instr_begin();
+					iter != block->instr_end(); ++iter)
+					visitInstruction(*iter);
+			}
+		}
+	}
+
+	void ConstantPropagation::markEdgeExecutable(
+		BasicBlock *from, BasicBlock *to)
+	{
+		if (!executableEdges.insert({ from, to }).second)
+			return;
+
+		if (executableBlocks.insert(to).second) {
+			blockWorklist.push_back(to);
+			return;
+		}
+		// only the phis can see a new edge.
+		for (auto P = to->phi_begin(); P != to->phi_end(); ++P)
+			visitPhi(*P);
+	}
+
+	void ConstantPropagation::visitInstruction(Instruction *instr)
+	{
+		if (instr->is_phi_node())
+			visitPhi(static_cast<Phi*>(instr));
+		else if (instr->is_branch())
+			visitBranch(static_cast<Branch*>(instr));
+		else if (instr->is_goto())
+			markEdgeExecutable(instr->get_parent(),
+				static_cast<Goto*>(instr)->block());
+		else if (instr->is_output())
+			updateLattice(instr, evaluate(instr));
+	}
+
+	void ConstantPropagation::visitPhi(Phi *phi)
+	{
+		BasicBlock *block = phi->get_parent();
+		LatticeValue result;
+		for (size_t i = 0; i < phi->get_num_operands(); ++i) {
+			auto edge = std::make_pair(phi->getIncomingBlock(i), block);
+			if (!executableEdges.count(edge))
+				continue;
+
+			LatticeValue value = getLattice(phi->get_operand(i));
+			if (value.state == LatticeValue::Unknown)
+				continue;
+			if (value.state == LatticeValue::Overdefined
+				|| (result.state == LatticeValue::Const && result != value)) {
+				result.state = LatticeValue::Overdefined;
+				break;
+			}
+			result = value;
+		}
+		updateLattice(phi, result);
+	}
+
+	void ConstantPropagation::visitBranch(Branch *branch)
+	{
+		BasicBlock *block = branch->get_parent();
+		LatticeValue cond = getLattice(branch->get_cond());
+		if (cond.state == LatticeValue::Const) {
+			markEdgeExecutable(block, logicValue(cond)
+				? branch->then() : branch->_else());
+			return;
+		}
+		markEdgeExecutable(block, branch->then());
+		markEdgeExecutable(block, branch->_else());
+	}
+
+	void ConstantPropagation::updateLattice(
+		Instruction *instr, const LatticeValue &value)
+	{
+		LatticeValue &current = lattice[instr];
+		if (current.state == LatticeValue::Overdefined
+			|| value.state == LatticeValue::Unknown)
+			return;
+
+		LatticeValue next = value;
+		if (current.state == LatticeValue::Const && current != value)
+			next.state = LatticeValue::Overdefined;
+		if (current == next)
+			return;
+
+		current = next;
+		for (auto use = instr->use_begin(); use != instr->use_end(); ++use)
+			instrWorklist.push_back(static_cast<Instruction*>(
+				(*use)->get_user()));
+	}
+
+	ConstantPropagation::LatticeValue
+	ConstantPropagation::getLattice(Value *value)
+	{
+		LatticeValue result;
+		if (value->is_instr())
+			return lattice[value];
+		if (!value->is_const()) {
+			result.state = LatticeValue::Overdefined;
+			return result;
+		}
+
+		Constant *cons = static_cast<Constant*>(value);
+		result.state = LatticeValue::Const;
+		result.type = cons->type();
+		switch (cons->type())
+		{
+		case Constant::Integer:
+			result.num = cons->getInteger(); break;
+		case Constant::Boolean:
+			result.num = cons->getBoolean(); break;
+		case Constant::Character:
+			result.num = cons->getChar(); break;
+		case Constant::Float:
+			result.fnum = cons->getFloat(); break;
+		case Constant::String:
+			result.str = cons->getString(); break;
+		default:
+			break;
+		}
+		return result;
+	}
+
+	ConstantPropagation::LatticeValue
+	ConstantPropagation::evaluate(Instruction *instr)
+	{
+		LatticeValue result;
+		result.state = LatticeValue::Overdefined;
+		switch (instr->get_opcode())
+		{
+		case Instruction::AssignVal:
+		{
+			Assign *assign = static_cast<Assign*>(instr);
+			if (assign->get_num_operands() == 0)
+				return result;
+			return getLattice(assign->get_value());
+		}
+		case Instruction::NotOpVal:
+		{
+			LatticeValue value = getLattice(
+				static_cast<NotOp*>(instr)->get_value());
+			if (value.state != LatticeValue::Const)
+				return value;
+			return foldNot(value);
+		}
+		case Instruction::BinaryOpsVal:
+		{
+			BinaryOperator *BO = static_cast<BinaryOperator*>(instr);
+			LatticeValue lhs = getLattice(BO->get_lhs());
+			LatticeValue rhs = getLattice(BO->get_rhs());
+			if (lhs.state == LatticeValue::Overdefined
+				|| rhs.state == LatticeValue::Overdefined)
+				return result;
+			if (lhs.state == LatticeValue::Unknown
+				|| rhs.state == LatticeValue::Unknown)
+				return LatticeValue();
+			return foldBinary(BO->op(), lhs, rhs);
+		}
+		default:
+			return result;
+		}
+	}
+
+	//
+	// foldBinary - fold like the runtime would, see Buildin.cpp. Results
+	// which don't fit a constant stay overdefined.
+	ConstantPropagation::LatticeValue
+	ConstantPropagation::foldBinary(unsigned op,
+		const LatticeValue &lhs, const LatticeValue &rhs)
+	{
+		LatticeValue result;
+		result.state = LatticeValue::Const;
+
+		bool ints = isIntLike(lhs.type) && isIntLike(rhs.type);
+		bool numbers = isNumber(lhs.type) && isNumber(rhs.type);
+		double left = lhs.type == Constant::Float ? lhs.fnum : lhs.num;
+		double right = rhs.type == Constant::Float ? rhs.fnum : rhs.num;
+
+		switch (op)
+		{
+		case BinaryOperator::Add:
+		case BinaryOperator::Sub:
+		case BinaryOperator::Mul:
+		case BinaryOperator::Div:
+			if (ints) {
+				// wide literals are reals at runtime, and a result
+				// which leaves the fixnum range becomes one too.
+				if (!FixnumFits(lhs.num) || !FixnumFits(rhs.num))
+					break;
+				int64_t x = lhs.num, y = rhs.num, value = 0;
+				bool overflow = false;
+				switch (op)
+				{
+				case BinaryOperator::Add:
+					overflow = __builtin_add_overflow(x, y, &value);
+					break;
+				case BinaryOperator::Sub:
+					overflow = __builtin_sub_overflow(x, y, &value);
+					break;
+				case BinaryOperator::Mul:
+					overflow = __builtin_mul_overflow(x, y, &value);
+					break;
+				case BinaryOperator::Div:
+					if (y == 0) {
+						result.type = Constant::Null;
+						return result;
+					}
+					value = x / y;
+					break;
+				}
+				if (overflow || !FixnumFits(value))
+					break;
+				result.type = Constant::Integer;
+				result.num = static_cast<intptr_t>(value);
+				return result;
+			}
+			if (numbers) {
+				result.type = Constant::Float;
+				switch (op)
+				{
+				case BinaryOperator::Add: result.fnum = left + right; break;
+				case BinaryOperator::Sub: result.fnum = left - right; break;
+				case BinaryOperator::Mul: result.fnum = left * right; break;
+				case BinaryOperator::Div: result.fnum = left / right; break;
+				}
+				return result;
+			}
+			if (op == BinaryOperator::Add
+				&& lhs.type == Constant::String
+				&& rhs.type == Constant::String) {
+				result.type = Constant::String;
+				result.str = lhs.str + rhs.str;
+				return result;
+			}
+			break;
+
+		case BinaryOperator::Great:
+		case BinaryOperator::Less:
+		case BinaryOperator::NotGreat:
+		case BinaryOperator::NotLess:
+		{
+			if (!numbers)
+				break;
+			int order;
+			if (ints)
+				order = (lhs.num > rhs.num) - (lhs.num < rhs.num);
+			else if (left != left || right != right)
+				order = 2;	// unordered
+			else
+				order = (left > right) - (left < right);
+
+			bool value = false;
+			switch (op)
+			{
+			case BinaryOperator::Great: value = order == 1; break;
+			case BinaryOperator::Less: value = order == -1; break;
+			case BinaryOperator::NotGreat:
+				value = order == -1 || order == 0; break;
+			case BinaryOperator::NotLess:
+				value = order == 1 || order == 0; break;
+			}
+			result.type = Constant::Boolean;
+			result.num = value;
+			return result;
+		}
+
+		case BinaryOperator::Equal:
+		case BinaryOperator::NotEqual:
+		{
+			bool equal;
+			if (ints)
+				equal = lhs.num == rhs.num;
+			else if (numbers)
+				equal = left == right;
+			else if (lhs.type == Constant::String
+				&& rhs.type == Constant::String)
+				equal = lhs.str == rhs.str;
+			else if (lhs.type == Constant::Null
+				&& rhs.type == Constant::Null)
+				equal = true;
+			else
+				break;
+			result.type = Constant::Boolean;
+			result.num = (op == BinaryOperator::Equal) == equal;
+			return result;
+		}
+
+		default:
+			break;
+		}
+
+		result.state = LatticeValue::Overdefined;
+		return result;
+	}
+
+	ConstantPropagation::LatticeValue
+	ConstantPropagation::foldNot(const LatticeValue &value)
+	{
+		LatticeValue result;
+		result.state = LatticeValue::Const;
+		result.type = Constant::Boolean;
+		result.num = !logicValue(value);
+		return result;
+	}
+
+	// like ToLogicValue, only nil and fixnum zero are false.
+	bool ConstantPropagation::logicValue(const LatticeValue &value)
+	{
+		if (value.type == Constant::Null)
+			return false;
+		if (isIntLike(value.type))
+			return value.num != 0;
+		return true;
+	}
+
+	void ConstantPropagation::rewriteFunction(IRFunction *func)
+	{
+		// decide every branch first, replacing an instruction
+		// moves its uses to the new assign.
+		std::vector<std::pair<Branch*, bool>> branches;
+		std::vector<Instruction*> constants;
+		for (auto *block : *func) {
+			if (!executableBlocks.count(block))
+				continue;
+			for (auto iter = block->instr_begin();
+				iter != block->instr_end(); ++iter) {
+				Instruction *instr = *iter;
+				if (instr->is_branch()) {
+					Branch *branch = static_cast<Branch*>(instr);
+					LatticeValue cond = getLattice(branch->get_cond());
+					if (cond.state == LatticeValue::Const)
+						branches.push_back({ branch, logicValue(cond) });
+					continue;
+				}
+				if (!instr->is_output()
+					|| lattice[instr].state != LatticeValue::Const)
+					continue;
+				// already as simple as it gets.
+				if (instr->is_assign() && instr->get_num_operands() == 1
+					&& instr->get_operand(0)->is_const())
+					continue;
+				constants.push_back(instr);
+			}
+		}
+
+		for (auto &branch : branches)
+			foldBranch(branch.first, branch.second);
+		for (auto *instr : constants)
+			replaceWithConstant(instr, lattice[instr]);
+	}
+
+	void ConstantPropagation::foldBranch(Branch *branch, bool taken)
+	{
+		BasicBlock *block = branch->get_parent();
+		BasicBlock *live = taken ? branch->then() : branch->_else();
+		BasicBlock *dead = taken ? branch->_else() : branch->then();
+
+		branch->erase_from_parent();
+		IRContext::createAtEnd<Goto>(block, live);
+		if (live == dead)
+			return;
+
+		block->successor_remove(dead);
+		dead->precursor_remove(block);
+		for (auto P = dead->phi_begin(); P != dead->phi_end(); ++P)
+			(*P)->removeIncomingBlock(block);
+	}
+
+	void ConstantPropagation::replaceWithConstant(
+		Instruction *instr, const LatticeValue &value)
+	{
+		Constant *cons = nullptr;
+		switch (value.type)
+		{
+		case Constant::Integer:
+			cons = IRContext::create<Constant>(
+				static_cast<int64_t>(value.num));
+			break;
+		case Constant::Boolean:
+			cons = IRContext::create<Constant>(value.num != 0);
+			break;
+		case Constant::Character:
+			cons = IRContext::create<Constant>(static_cast<char>(value.num));
+			break;
+		case Constant::Float:
+			cons = IRContext::create<Constant>(value.fnum);
+			break;
+		case Constant::String:
+			cons = IRContext::create<Constant>(value.str);
+			break;
+		default:
+			cons = IRContext::create<Constant>();
+			break;
+		}
+
+		// phis stay together at the front of their block.
+		BasicBlock *block = instr->get_parent();
+		auto iter = std::find(block->instr_begin(), block->instr_end(), instr);
+		while ((*iter)->is_phi_node())
+			++iter;
+		Value *assign = IRContext::insertAfter<Assign>(
+			iter, static_cast<Value*>(cons), instr->get_value_name());
+		instr->replace_all_uses_with(assign);
+		instr->erase_from_parent();
+	}
+}
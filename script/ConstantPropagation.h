@@ -0,0 +1,74 @@
+#pragma once
+
+#include <set>
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "Pass.h"
+
+namespace script
+{
+    class Value;
+    class Instruction;
+    class BasicBlock;
+    class Branch;
+    class Phi;
+
+    //
+    // sparse conditional constant propagation, values are only
+    // evaluated along edges that may execute. Constant instructions
+    // become constant assigns and branches on constants become gotos,
+    // the blocks left behind are for UnreachableBlockElimination.
+    //
+    class ConstantPropagation : public FunctionPass
+    {
+    public:
+        virtual ~ConstantPropagation() = default;
+
+        void runOnFunction(IRFunction *func);
+
+    private:
+        struct LatticeValue {
+            enum State { Unknown, Const, Overdefined };
+
+            State state;
+            unsigned type;          // Constant::Null, Integer, ...
+            intptr_t num;           // Integer, Boolean and Character
+            double fnum;
+            std::string str;
+
+            LatticeValue() : state(Unknown), type(0), num(0), fnum(0) {}
+            bool operator == (const LatticeValue &rhs) const;
+            bool operator != (const LatticeValue &rhs) const {
+                return !(*this == rhs);
+            }
+        };
+
+        void solve(IRFunction *func);
+        void markEdgeExecutable(BasicBlock *from, BasicBlock *to);
+        void visitInstruction(Instruction *instr);
+        void visitPhi(Phi *phi);
+        void visitBranch(Branch *branch);
+        void updateLattice(Instruction *instr, const LatticeValue &value);
+
+        LatticeValue getLattice(Value *value);
+        LatticeValue evaluate(Instruction *instr);
+        LatticeValue foldBinary(unsigned op,
+            const LatticeValue &lhs, const LatticeValue &rhs);
+        LatticeValue foldNot(const LatticeValue &value);
+        bool logicValue(const LatticeValue &value);
+
+        void rewriteFunction(IRFunction *func);
+        void foldBranch(Branch *branch, bool taken);
+        void replaceWithConstant(Instruction *instr,
+            const LatticeValue &value);
+
+        std::map<Value*, LatticeValue> lattice;
+        std::set<BasicBlock*> executableBlocks;
+        std::set<std::pair<BasicBlock*, BasicBlock*>> executableEdges;
+        std::vector<BasicBlock*> blockWorklist;
+        std::vector<Instruction*> instrWorklist;
+    };
+}
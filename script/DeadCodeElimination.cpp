@@ -1,24 +1,98 @@
-#include "DeadCodeElimination.h"
-
-#include "CFG.h"
-#include <cassert>
-
-namespace script
-{
-    void DeadCodeElimination::runOnFunction(IRFunction *func) 
-    {
-        assert(func);
-
-
-    }
-
-    void DeadCodeElimination::visit(BasicBlock *block)
-    {
-
-    }
-
-    void DeadCodeElimination::eraseUnreachableCode() 
-    {
-
-    }
-}
\ No newline at end of file
+#include "DeadCodeElimination.h"
+
+#include "CFG.h"
+#include "IRModule.h"
+#include "Instruction.h"
+#include <cassert>
+
+namespace script
+{
+    void DeadCodeElimination::runOnFunction(IRFunction *func) 
+    {
+        assert(func);
+        live.clear();
+        worklist.clear();
+
+        for (auto *block : *func)
+            visit(block);
+
+        while (!worklist.empty()) {
+            Instruction *instr = worklist.back();
+            worklist.pop_back();
+            for (auto op = instr->op_begin(); op != instr->op_end(); ++op) {
+                Value *value = op->get_value();
+                if (value && value->is_instr())
+                    markLive(static_cast<Instruction*>(value));
+            }
+        }
+
+        eraseDeadCode(func);
+    }
+
+    // roots of the mark phase.
+    void DeadCodeElimination::visit(BasicBlock *block)
+    {
+        assert(block);
+        for (auto iter = block->instr_begin(); 
+            iter != block->instr_end(); ++iter) {
+            if (hasSideEffect(*iter))
+                markLive(*iter);
+        }
+    }
+
+    void DeadCodeElimination::markLive(Instruction *instr)
+    {
+        if (live.insert(instr).second)
+            worklist.push_back(instr);
+    }
+
+    bool DeadCodeElimination::hasSideEffect(Instruction *instr) const
+    {
+        switch (instr->get_opcode())
+        {
+        case Instruction::InvokeVal:
+        case Instruction::SetIndexVal:
+        case Instruction::StoreVal:
+        case Instruction::BranchVal:
+        case Instruction::GotoVal:
+        case Instruction::ReturnVal:
+        case Instruction::ReturnVoidVal:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    void DeadCodeElimination::eraseDeadCode(IRFunction *func)
+    {
+        std::vector<Instruction*> deadInstrs;
+        for (auto *block : *func) {
+            for (auto iter = block->instr_begin(); 
+                iter != block->instr_end(); ++iter) {
+                if (!live.count(*iter))
+                    deadInstrs.push_back(*iter);
+            }
+        }
+
+        // dead instructions only use each other, drop every reference
+        // first so that none is deleted while still used. An operand
+        // like undef may be shared, it goes with its last user.
+        std::set<Value*> values;
+        for (auto *instr : deadInstrs) {
+            for (auto op = instr->op_begin(); op != instr->op_end(); ++op) {
+                Value *value = op->get_value();
+                if (value && value->is_value())
+                    values.insert(value);
+            }
+            instr->drop_all_references();
+        }
+
+        for (auto *instr : deadInstrs)
+            instr->erase_from_parent();
+
+        for (auto *value : values) {
+            if (value->use_size() == 0)
+                delete value;
+        }
+    }
+}
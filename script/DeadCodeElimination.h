@@ -1,21 +1,32 @@
-#pragma once 
-
-#include "Pass.h"
-#include <set>
-
-namespace script
-{
-    class BasicBlock;
-    
-    class DeadCodeElimination : public FunctionPass
-    {
-    public:
-        virtual ~DeadCodeElimination() = default;
-
-        void runOnFunction(IRFunction *func);
-
-    private:
-        void visit(BasicBlock *block);
-        void eraseUnreachableCode();
-    };
-}
\ No newline at end of file
+#pragma once 
+
+#include "Pass.h"
+#include <set>
+#include <vector>
+
+namespace script
+{
+    class BasicBlock;
+    class Instruction;
+    
+    //
+    // mark and sweep over uses, an instruction is live when it has
+    // side effects or a live instruction uses it.
+    //
+    class DeadCodeElimination : public FunctionPass
+    {
+    public:
+        virtual ~DeadCodeElimination() = default;
+
+        void runOnFunction(IRFunction *func);
+
+    private:
+        void visit(BasicBlock *block);
+        void markLive(Instruction *instr);
+        void eraseDeadCode(IRFunction *func);
+        bool hasSideEffect(Instruction *instr) const;
+
+        std::set<Instruction*> live;
+        std::vector<Instruction*> worklist;
+    };
+}
@@ -1,204 +1,414 @@
-﻿#include <stdexcept>
-#include <assert.h>
-#include <iostream>
-#include <string.h>
-
-#include "GC.h"
-
-namespace script
-{
-    size_t Ceil(size_t size)
-    {
-        int c = size % sizeof(Object);
-        if (c != 0) c = sizeof(Object) - c;
-        return size + c;
-    }
-
-    Semispace::Semispace(size_t size)
-    {
-        space_size_ = Ceil(size);
-        bottom_ = new char[space_size_];
-        end_ = bottom_ + space_size_;
-        top_ = bottom_;
-        free_space_ = space_size_;
-    }
-
-    Semispace::~Semispace()
-    {
-        delete []bottom_;
-    }
-
-    inline bool Semispace::contains(Object obj)
-    {
-        return ((Object)bottom_ <= obj && obj < (Object)end_);
-    }
-
-    inline void Semispace::reset()
-    {
-        top_ = bottom_;
-		free_space_ = space_size_;
-    }
-
-    Object Semispace::allocateMemory(size_t size)
-    {
-        size_t space_size = Ceil(size);
-        if (top_ + space_size > end_)
-            return (Object)nullptr;
-        Object obj = (Object)top_;
-        top_ += space_size;
-        free_space_ -= size;
-        return obj;
-    }
-
-
-    GarbageCollector::GarbageCollector(size_t size)
-    {
-        this->size_ = size;
-        this->space_size_ = Ceil(size) >> 2;
-        this->from_space_ = new Semispace(space_size_);
-        this->to_space_ = new Semispace(space_size_);
-    }
-
-    GarbageCollector::~GarbageCollector()
-    {
-        delete from_space_;
-        delete to_space_;
-    }
-
-    void GarbageCollector::swapSpace()
-    {
-        Semispace* temp = from_space_;
-        from_space_ = to_space_;
-        to_space_ = temp;
-
-        // After swapping, the to-space is assumed to be empty.
-        // Reset its allocation Object.
-        to_space_->reset();
-		//cleanSpace(to_space_);
-    }
-
-	void GarbageCollector::cleanSpace(Semispace * space)
-	{
-		memset(space->bottom_, 0, space->space_size_);
-	}
-
-    // offset / 4 is the index of obj's forward.
-    bool GarbageCollector::isForwarded(Object obj)
-    {
-        size_t offset = obj - (Object)from_space_->bottom_;
-        int *forward = (int*)this->forward_;
-        return (forward[offset >> 2] != 0);
-    }
-
-    // set the obj's forward to new addr.
-    void GarbageCollector::forwardTo(Object obj, Object new_addr)
-    {
-        size_t offset = obj - (Object)from_space_->bottom_;
-        int *forward = (int*)this->forward_;
-        forward[offset >> 2] = new_addr;
-    }
-
-    // get the new addr of obj.
-    Object GarbageCollector::forwardee(Object obj)
-    {
-        size_t offset = obj - (Object)from_space_->bottom_;
-        int *forward = (int*)this->forward_;
-        return forward[offset >> 2];
-    }
-
-    // copy object to to_space.
-    Object GarbageCollector::swap(Object obj, size_t size)
-    {
-        Object dest = to_space_->allocateMemory(size);
-        memcpy((void*)dest, (void*)obj, size);
-        return dest;
-    }
-
-    void GarbageCollector::processReference(Object *slot)
-    {
-        size_t size = SizeOfObject(*slot);
-        if (size <= 0)
-            return;
-
-        Object obj = *slot;
-        if (obj == 0) return;
-
-        if (from_space_->contains(obj))
-        {
-            if (!isForwarded(obj))
-            {
-                Object new_obj = swap(obj, size);
-                forwardTo(obj, new_obj);
-                *slot = new_obj;
-            }
-            else
-            {
-                *slot = forwardee(obj);
-            }
-        }
-    }
-
-    void GarbageCollector::garbageCollect()
-    {
-        size_t old = from_space_->free_space_;
-
-        forward_ = new Object[Ceil(space_size_)];
-        memset((void*)forward_, 0, Ceil(space_size_));
-
-        // queue
-        Object scanned = (Object)to_space_->bottom_;
-
-        // copy all glboal variables
-        globalVariable_();
-
-        // breadth-first scanning of object graph
-        while (scanned < (Object)to_space_->top_)
-        {
-            Object parent_obj = scanned;
-            variableReference_(&parent_obj);
-            scanned += SizeOfObject(parent_obj);
-        }
-
-        // Now all live objects will have been evacuated into the to-space,
-        // and we don't need the data in the from-space anymore.
-        swapSpace();
-
-        delete[]forward_;
-        forward_ = nullptr;
-
-#ifdef _DEBUG
-        std::cout << "[GC] before free: " << old
-            << ", after free: " << from_space_->free_space_
-			<< ", used space:" << from_space_->space_size_ - from_space_->free_space_
-            << ", total free space: " << from_space_->free_space_ - old << std::endl;
-#endif // _DEBUG
-	}
-
-    Object GarbageCollector::allocate(size_t size)
-    {
-        assert(variableReference_ && globalVariable_);
-
-        Object address = (Object)from_space_->allocateMemory(size);
-        if (address == 0)
-        {
-            garbageCollect();
-            address = from_space_->allocateMemory(size);
-            if (address == 0)
-            {
-                // error
-                throw std::runtime_error("Allocate memory failure!");
-            }
-        }
-        return address;
-    }
-
-    void GarbageCollector::bindReference(std::function<VariableReference> call)
-    {
-        variableReference_ = std::move(call);
-    }
-
-    void GarbageCollector::bindGlobals(std::function<GloablVariable> call)
-    {
-        globalVariable_ = std::move(call);
-    }
-}
+﻿#include <stdexcept>
+#include <assert.h>
+#include <iostream>
+#include <string.h>
+
+#include "GC.h"
+
+namespace script
+{
+    size_t Ceil(size_t size)
+    {
+        int c = size % sizeof(Object);
+        if (c != 0) c = sizeof(Object) - c;
+        return size + c;
+    }
+
+    Semispace::Semispace(size_t size)
+    {
+        space_size_ = Ceil(size);
+        bottom_ = new char[space_size_];
+        end_ = bottom_ + space_size_;
+        top_ = bottom_;
+        free_space_ = space_size_;
+    }
+
+    Semispace::~Semispace()
+    {
+        delete []bottom_;
+    }
+
+    inline void Semispace::reset()
+    {
+        top_ = bottom_;
+		free_space_ = space_size_;
+    }
+
+    Object Semispace::allocateMemory(size_t size)
+    {
+        size_t space_size = Ceil(size);
+        if (top_ + space_size > end_)
+            return (Object)nullptr;
+        Object obj = (Object)top_;
+        top_ += space_size;
+        free_space_ -= size;
+        return obj;
+    }
+
+
+    // survival ratio of old space after full collection.
+    static const double GrowThreshold = 0.5;
+    static const double ShrinkThreshold = 0.125;
+
+    GarbageCollector::GarbageCollector(const GCOptions &options)
+        : options_(options)
+    {
+        if (options_.maxSize < options_.initialSize)
+            options_.maxSize = options_.initialSize;
+        if (options_.growthFactor <= 1.0)
+            options_.growthFactor = 2.0;
+
+        size_t space_size = Ceil(options_.initialSize);
+        this->from_space_ = new Semispace(space_size);
+        this->to_space_ = new Semispace(space_size);
+        this->nursery_ = options_.generational
+            ? new Semispace(space_size >> 2) : nullptr;
+        this->collection_ = Major;
+        this->pending_ = 0;
+    }
+
+    GarbageCollector::~GarbageCollector()
+    {
+        delete from_space_;
+        delete to_space_;
+        delete nursery_;
+        for (auto *space : permanent_)
+            delete space;
+    }
+
+    void GarbageCollector::swapSpace()
+    {
+        Semispace* temp = from_space_;
+        from_space_ = to_space_;
+        to_space_ = temp;
+
+        // After swapping, the to-space is assumed to be empty.
+        // Reset its allocation Object.
+        to_space_->reset();
+		//cleanSpace(to_space_);
+    }
+
+	void GarbageCollector::cleanSpace(Semispace * space)
+	{
+		memset(space->bottom_, 0, space->space_size_);
+	}
+
+    // whether obj will be evacuated by current collection, minor 
+    // collection only moves nursery objects.
+    bool GarbageCollector::evacuating(Object obj)
+    {
+        if (nursery_ && nursery_->contains(obj))
+            return true;
+        return collection_ == Major && from_space_->contains(obj);
+    }
+
+    // copy object to to_space, or promote it into the old space 
+    // during minor collection.
+    Object GarbageCollector::swap(Object obj, size_t size)
+    {
+        Semispace *space = collection_ == Minor ? from_space_ : to_space_;
+        Object dest = space->allocateMemory(size);
+        assert(dest && "evacuation must not overflow");
+        memcpy((void*)dest, (void*)obj, size);
+        ObjectSetRemembered(dest, false);
+        return dest;
+    }
+
+    // The forwarding pointer overwrites the header of evacuated object,
+    // so check it before asking the size.
+    void GarbageCollector::processReference(Object *slot)
+    {
+        Object obj = *slot;
+        if (obj == 0 || IsTagging(obj) || IsUndef(obj))
+            return;
+
+        if (!evacuating(obj))
+            return;
+
+        if (!IsForwarded(obj))
+        {
+            Object new_obj = swap(obj, SizeOfObject(obj));
+            ObjectForwardTo(obj, new_obj);
+            *slot = new_obj;
+        }
+        else
+        {
+            *slot = ObjectForwardee(obj);
+        }
+    }
+
+    // breadth-first scanning of object graph
+    void GarbageCollector::scan(Semispace *space, char *scanned)
+    {
+        while (scanned < space->top_)
+        {
+            Object parent_obj = (Object)scanned;
+            variableReference_(&parent_obj);
+            scanned += Ceil(SizeOfObject(parent_obj));
+        }
+    }
+
+    void GarbageCollector::remember(Object host)
+    {
+        ObjectSetRemembered(host, true);
+        remembered_.push_back(host);
+    }
+
+    void GarbageCollector::clearRemembered()
+    {
+        for (Object host : remembered_)
+            ObjectSetRemembered(host, false);
+        remembered_.clear();
+    }
+
+    // to-space must hold every live object, it is empty between
+    // collections so replacing it is cheap.
+    void GarbageCollector::reserveToSpace(size_t size)
+    {
+        if (to_space_->space_size_ >= size)
+            return;
+        delete to_space_;
+        to_space_ = new Semispace(size);
+    }
+
+    // Called after a full collection, sizes the empty to-space for
+    // next one, the from-space follows when they swap.
+    void GarbageCollector::adjustHeap()
+    {
+        size_t capacity = from_space_->space_size_;
+        size_t reserve = (nursery_ ? nursery_->space_size_ : 0) + pending_;
+        size_t live = from_space_->used() + reserve;
+        double survival = (double)live / capacity;
+
+        size_t target = capacity;
+        if (survival > GrowThreshold)
+        {
+            target = (size_t)(capacity * options_.growthFactor);
+            if (target < (size_t)(live / GrowThreshold))
+                target = (size_t)(live / GrowThreshold);
+        }
+        else if (survival < ShrinkThreshold)
+        {
+            target = (size_t)(capacity / options_.growthFactor);
+        }
+
+        if (target > options_.maxSize)
+            target = options_.maxSize;
+        if (target < options_.initialSize)
+            target = options_.initialSize;
+        target = Ceil(target);
+        if (target == to_space_->space_size_)
+            return;
+
+        delete to_space_;
+        to_space_ = new Semispace(target);
+    }
+
+    void GarbageCollector::recordCollection(
+        Clock::time_point start, size_t collected, size_t copied)
+    {
+        std::chrono::duration<double, std::micro> pause = 
+            Clock::now() - start;
+        if (collection_ == Minor)
+            stats_.minorCollections++;
+        else
+            stats_.majorCollections++;
+        stats_.lastPause = pause.count();
+        stats_.totalPause += stats_.lastPause;
+        if (stats_.lastPause > stats_.maxPause)
+            stats_.maxPause = stats_.lastPause;
+        stats_.bytesCollected += collected;
+        stats_.bytesCopied += copied;
+        stats_.lastSurvival = collected ? (double)copied / collected : 0;
+    }
+
+    void GarbageCollector::garbageCollect()
+    {
+        size_t old = from_space_->free_space_;
+        Clock::time_point start = Clock::now();
+        size_t collected = from_space_->used() 
+            + (nursery_ ? nursery_->used() : 0);
+
+        reserveToSpace(from_space_->used() 
+            + (nursery_ ? nursery_->used() : 0));
+
+        collection_ = Major;
+        // all remembered hosts are evacuated or dead after it.
+        remembered_.clear();
+
+        // queue
+        char *scanned = to_space_->bottom_;
+
+        // copy all glboal variables
+        globalVariable_();
+
+        scan(to_space_, scanned);
+
+        // Now all live objects will have been evacuated into the to-space,
+        // and we don't need the data in the from-space anymore.
+        swapSpace();
+
+        if (nursery_)
+            nursery_->reset();
+        recordCollection(start, collected, from_space_->used());
+
+        // to-space may be reserved beyond max size to finish evacuation.
+        if (from_space_->used() > options_.maxSize)
+            throw std::runtime_error("Allocate memory failure!");
+        adjustHeap();
+
+#ifdef _DEBUG
+        std::cout << "[GC] before free: " << old
+            << ", after free: " << from_space_->free_space_
+			<< ", used space:" << from_space_->space_size_ - from_space_->free_space_
+            << ", total free space: " << from_space_->free_space_ - old << std::endl;
+#endif // _DEBUG
+	}
+
+    // Evacuate live nursery objects into the old space. Roots are the
+    // globals and every old object remembered by the write barrier.
+    void GarbageCollector::minorCollect()
+    {
+        size_t young = nursery_->used();
+        Clock::time_point start = Clock::now();
+
+        collection_ = Minor;
+
+        // promoted objects are appended to the old space.
+        char *scanned = from_space_->top_;
+
+        globalVariable_();
+        for (Object host : remembered_)
+        {
+            ObjectSetRemembered(host, false);
+            variableReference_(&host);
+        }
+        remembered_.clear();
+
+        scan(from_space_, scanned);
+
+        nursery_->reset();
+        recordCollection(start, young, from_space_->top_ - scanned);
+        collection_ = Major;
+
+#ifdef _DEBUG
+        std::cout << "[GC] minor, nursery used: " << young
+            << ", promoted: " << from_space_->top_ - scanned << std::endl;
+#endif // _DEBUG
+    }
+
+    // A minor collection promotes at most whole nursery, fall back to
+    // full collection when the old space can't hold that.
+    void GarbageCollector::collectNursery()
+    {
+        if (from_space_->available() < nursery_->used())
+            garbageCollect();
+        else
+            minorCollect();
+    }
+
+    Object GarbageCollector::allocateOld(size_t size)
+    {
+        Object address = (Object)from_space_->allocateMemory(size);
+        if (address == 0)
+        {
+            pending_ = Ceil(size);
+            garbageCollect();
+            address = from_space_->allocateMemory(size);
+
+            // heap grown by last collection takes effect after next one.
+            if (address == 0 
+                && to_space_->space_size_ > from_space_->space_size_)
+            {
+                garbageCollect();
+                address = from_space_->allocateMemory(size);
+            }
+            pending_ = 0;
+            if (address == 0)
+            {
+                // error
+                throw std::runtime_error("Allocate memory failure!");
+            }
+        }
+        return address;
+    }
+
+    Object GarbageCollector::allocate(size_t size)
+    {
+        assert(variableReference_ && globalVariable_);
+        stats_.bytesAllocated += size;
+
+        // large objects are pretenured.
+        if (!nursery_ || size > (nursery_->space_size_ >> 2))
+            return allocateOld(size);
+
+        Object address = nursery_->allocateMemory(size);
+        if (address == 0)
+        {
+            collectNursery();
+            address = nursery_->allocateMemory(size);
+            if (address == 0)
+            {
+                // error
+                throw std::runtime_error("Allocate memory failure!");
+            }
+        }
+        return address;
+    }
+
+    Object GarbageCollector::allocatePermanent(size_t size)
+    {
+        static const size_t ChunkSize = 64 * 1024;
+
+        Object address = 0;
+        if (!permanent_.empty())
+            address = permanent_.back()->allocateMemory(size);
+        if (address == 0)
+        {
+            permanent_.push_back(new Semispace(
+                size > ChunkSize ? size : ChunkSize));
+            address = permanent_.back()->allocateMemory(size);
+        }
+        return address;
+    }
+
+    size_t GarbageCollector::heapSize() const
+    {
+        size_t size = from_space_->space_size_ + to_space_->space_size_;
+        if (nursery_)
+            size += nursery_->space_size_;
+        return size;
+    }
+
+    std::vector<TypeUsage> GarbageCollector::liveHistogram()
+    {
+        garbageCollect();
+
+        std::vector<TypeUsage> usage;
+        for (size_t type = 0; type < ObjectTypeCount(); ++type)
+            usage.push_back({ ObjectTypeName(type), 0, 0 });
+
+        // from-space only holds live objects after full collection.
+        char *scanned = from_space_->bottom_;
+        while (scanned < from_space_->top_)
+        {
+            Object obj = (Object)scanned;
+            size_t size = Ceil(SizeOfObject(obj));
+            TypeUsage &entry = usage[ObjectType(obj)];
+            entry.count++;
+            entry.bytes += size;
+            scanned += size;
+        }
+        return usage;
+    }
+
+    void GarbageCollector::bindReference(std::function<VariableReference> call)
+    {
+        variableReference_ = std::move(call);
+    }
+
+    void GarbageCollector::bindGlobals(std::function<GloablVariable> call)
+    {
+        globalVariable_ = std::move(call);
+    }
+}
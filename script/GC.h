@@ -1,65 +1,141 @@
-﻿#ifndef __GC_H__
-#define __GC_H__
-
-#include <functional>
-#include "Runtime.h"
-
-namespace script
-{
-    struct Semispace
-    {
-        Semispace(size_t size);
-        ~Semispace();
-
-        Object allocateMemory(size_t size);
-        bool contains(Object obj);
-        void reset();
-
-        char* bottom_;
-        char* top_;
-        char* end_;
-		size_t space_size_;
-        size_t free_space_;
-    };
-
-    class GarbageCollector
-    {
-        using GloablVariable = void();
-        using VariableReference = void(Object *);
-    public:
-        GarbageCollector(size_t size);
-        ~GarbageCollector();
-
-        Object allocate(size_t size);
-
-        void bindReference(std::function<VariableReference> call);
-        void bindGlobals(std::function<GloablVariable> call);
-        void processReference(Object *slot);
-
-    private:
-        void garbageCollect();
-
-        void swapSpace();
-		void cleanSpace(Semispace *space);
-
-        bool isForwarded(Object obj);
-        void forwardTo(Object obj, Object new_addr);
-        Object forwardee(Object obj);
-
-        Object swap(Object obj, size_t size);
-
-    private:
-        std::function<VariableReference> variableReference_;
-        std::function<GloablVariable> globalVariable_;
-
-        Semispace *from_space_;
-        Semispace *to_space_;
-        size_t size_;
-        size_t space_size_;
-        size_t free_space_;
-        Object *forward_;
-    };
-
-}
-
-#endif // !__GC_H__
+﻿#ifndef __GC_H__
+#define __GC_H__
+
+#include <functional>
+#include <vector>
+#include <chrono>
+#include "Runtime.h"
+
+namespace script
+{
+    struct Semispace
+    {
+        Semispace(size_t size);
+        ~Semispace();
+
+        Object allocateMemory(size_t size);
+        void reset();
+
+        bool contains(Object obj) const
+        {
+            return ((Object)bottom_ <= obj && obj < (Object)end_);
+        }
+        size_t used() const { return top_ - bottom_; }
+        size_t available() const { return end_ - top_; }
+
+        char* bottom_;
+        char* top_;
+        char* end_;
+		size_t space_size_;
+        size_t free_space_;
+    };
+
+    // sizes are of one old generation semispace, the heap grows by
+    // growthFactor when much of it survives a full collection and
+    // shrinks back towards initialSize when little does.
+    struct GCOptions
+    {
+        size_t initialSize = 4 * 1024 * 1024;
+        size_t maxSize = 512 * 1024 * 1024;
+        double growthFactor = 2.0;
+        bool generational = true;
+    };
+
+    // cumulative counters since the collector was created, pauses
+    // are in microseconds and survival is copied / collected bytes.
+    struct GCStats
+    {
+        size_t minorCollections = 0;
+        size_t majorCollections = 0;
+        double totalPause = 0;
+        double maxPause = 0;
+        double lastPause = 0;
+        size_t bytesAllocated = 0;
+        size_t bytesCollected = 0;
+        size_t bytesCopied = 0;
+        double lastSurvival = 0;
+    };
+
+    struct TypeUsage
+    {
+        const char *name;
+        size_t count;
+        size_t bytes;
+    };
+
+    class GarbageCollector
+    {
+        using GloablVariable = void();
+        using VariableReference = void(Object *);
+    public:
+        // generational mode puts a bump allocated nursery in front of
+        // the semispaces, which then only hold the old generation.
+        GarbageCollector(const GCOptions &options = GCOptions());
+        ~GarbageCollector();
+
+        Object allocate(size_t size);
+
+        // allocate an object which is never moved nor freed, it must
+        // not hold references to collected objects.
+        Object allocatePermanent(size_t size);
+
+        void bindReference(std::function<VariableReference> call);
+        void bindGlobals(std::function<GloablVariable> call);
+        void processReference(Object *slot);
+
+        const GCStats &stats() const { return stats_; }
+        size_t heapSize() const;
+
+        // live objects grouped by type, runs a full collection first.
+        std::vector<TypeUsage> liveHistogram();
+
+        // must be called after storing value into a field of host,
+        // records old objects which point into the nursery.
+        void writeBarrier(Object host, Object value)
+        {
+            if (nursery_ && nursery_->contains(value)
+                && !nursery_->contains(host) && !ObjectRemembered(host))
+                remember(host);
+        }
+
+    private:
+        enum Collection { Minor, Major };
+        using Clock = std::chrono::steady_clock;
+
+        void garbageCollect();
+        void minorCollect();
+        void collectNursery();
+        Object allocateOld(size_t size);
+        void remember(Object host);
+        void clearRemembered();
+        void scan(Semispace *space, char *scanned);
+        void reserveToSpace(size_t size);
+        void adjustHeap();
+        void recordCollection(Clock::time_point start, 
+            size_t collected, size_t copied);
+
+        void swapSpace();
+		void cleanSpace(Semispace *space);
+
+        bool evacuating(Object obj);
+
+        Object swap(Object obj, size_t size);
+
+    private:
+        std::function<VariableReference> variableReference_;
+        std::function<GloablVariable> globalVariable_;
+
+        Semispace *from_space_;
+        Semispace *to_space_;
+        Semispace *nursery_;
+        std::vector<Semispace*> permanent_;
+        std::vector<Object> remembered_;
+        Collection collection_;
+        GCOptions options_;
+        size_t pending_;
+        GCStats stats_;
+    };
+
+}
+
+#endif // !__GC_H__
@@ -1,6 +1,6 @@
-#include "IRContext.h"
-
-namespace script
-{
-
+#include "IRContext.h"
+
+namespace script
+{
+
 }
\ No newline at end of file
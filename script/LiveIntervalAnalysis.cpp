@@ -1,235 +1,304 @@
-#include "LiveIntervalAnalysis.h"
-
-#include <cassert>
-#include <iostream>
-
-#include "CFG.h"
-#include "Instruction.h"
-#include "IRModule.h"
-
-namespace script
-{
-namespace {
-    static inline void operator += (
-        std::set<Value*> &lhs,
-        std::set<Value*> &rhs)
-    {
-        for (auto *V : rhs)
-            lhs.insert(V);
-    }
-
-#ifdef _DEBUG
-    static void dumpValue(Value *value)
-    {
-        if (value == nullptr)
-            return;
-        switch (value->get_subclass_id())
-        {
-        case Value::UndefVal:
-        {
-            std::cout << "[[Undef]]";
-            break;
-        }
-        case Value::ConstantVal:
-        {
-            std::cout << "[[Constant]]";;
-            break;
-        }
-        case Value::TableVal:
-        {
-            std::cout << "[[Table]]";
-            break;
-        }
-        case Value::UserClosureVal:
-        {
-            std::cout << "[function]:" <<
-				((UserClosure*)value)->getClosureName();
-            break;
-        }
-        case Value::ParamVal:
-        {
-            std::cout << "[Param]:" << ((Param*)value)->getParamName();
-            break;
-        }
-        case Value::InstructionVal:
-            std::cout << ((Instruction*)value)->get_value_name();
-            break;
-            //dump((Instruction*)value);
-        }
-    }
-#endif // _DEBUG
-}
-
-    void LiveIntervalAnalysis::runOnFunction(IRFunction *func)
-    {
-		func->computeBlockOrder();
-		computeLocalLiveSet(func);
-		computeGlobalLiveSet(func);
-
-#ifdef _DEBUG
-		std::cout << "Live analysis result:" << std::endl;
-		for (auto block = func->begin(), e = func->end();
-			block != e; ++block) {
-			BasicBlock *BB = *block;
-			std::cout << " " << BB->name_
-				<< "(" << BB->start_ 
-				<< ", " << BB->end_
-				<< "): " << std::endl;
-			std::cout << "  LiveIn = { ";
-			for (auto *val : BB->liveIn_) {
-				dumpValue(val);
-				std::cout << ", ";
-			}
-			std::cout << "}\n  LiveOut = { ";
-			for (auto *val : BB->liveOut_) {
-				dumpValue(val);
-				std::cout << ", ";
-			}
-			std::cout << "}\n  LiveGen = { ";
-			for (auto *val : BB->liveGen_) {
-				dumpValue(val);
-				std::cout << ", ";
-			}
-			std::cout << "}\n  LiveKill = { ";
-			for (auto *val : BB->liveKill_) {
-				dumpValue(val);
-				std::cout << ", ";
-			}
-			std::cout << "}\n" << std::endl;
-		}
-#endif // _DEBUG
-
-        buildIntervals(func);
-
-#ifdef _DEBUG
-		std::cout << "Begin dump intervals of function: "
-			<< func->getFunctionName() << std::endl;
-		for (auto &interval : intervals) {
-			std::cout << "    ";
-			dumpValue(interval.reg);
-			for (auto &range : interval.ranges) {
-				std::cout << " [" << range.start
-					<< ", " << range.end << ") ";
-			}
-			std::cout << std::endl;
-		}
-#endif // _DEBUG
-
-    }
-
-	LiveInterval *LiveIntervalAnalysis::getInterval(Value *val)
-    {
-        auto res = val2inter.find(val);
-        if (res == val2inter.end()) 
-        {
-            intervals.push_back({ val });
-			LiveInterval *I = &intervals.back();
-			val2inter.insert({ val, I });
-            return I;
-        }
-        return res->second;
-    }
-
-    void LiveIntervalAnalysis::buildIntervals(IRFunction *func) 
-    {
-        // The iteration is in reverse order so that all uses of 
-        // a virtual register are seen before its deﬁnition.
-		for (auto block = func->rbegin(), e = func->rend();
-			block != e; ++block) {
-			BasicBlock *BB = *block;
-			unsigned from = BB->getStart();
-			unsigned to = BB->getEnd();
-
-			for (auto *val : BB->liveOut_) {
-				getInterval(val)->addRange({ from, to });
-			}
-			
-			for (auto instr = BB->instr_rbegin();
-				instr != BB->instr_rend();
-				++instr) {
-				Instruction *I = *instr;
-
-				if (I->is_output()) {
-					LiveInterval *interval = getInterval(I);
-					//if (interval->empty())
-					//	interval->addRange({ I->getID(), to });
-					interval->setStart(I->getID());
-					interval->addUsePosition(I->getID());
-				}
-
-				for (auto op = I->op_begin();
-					op != I->op_end();
-					++op) {
-					Value *val = op->get_value();
-					if (val->is_value())
-						continue;
-
-					LiveInterval *interval = getInterval(val);
-					interval->addRange({ from, I->getID() + 2 });
-					interval->addUsePosition(I->getID());
-				}
-			}
-        }
-    }
-
-    void LiveIntervalAnalysis::swapIntervals(
-		std::list<LiveInterval> &to)
-    {
-        val2inter.clear();
-        std::swap(this->intervals, to);
-    }
-
-	void LiveIntervalAnalysis::computeLocalLiveSet(IRFunction *func)
-	{
-		for (auto block = func->begin(), e = func->end();
-			block != e; ++block) {
-			BasicBlock *BB = *block;
-			BB->liveGen_.clear();
-			BB->liveKill_.clear();
-			for (auto instr = BB->instr_begin();
-				instr != BB->instr_end();
-				++instr) {
-				Instruction *I = *instr;
-				if (I->is_output())
-					BB->liveKill_.insert(I);
-				for (auto op = I->op_begin();
-					op != I->op_end();
-					++op) {
-					Value *val = op->get_value();
-					if (val->is_value())
-						break;
-					if (!BB->liveKill_.count(val))
-						BB->liveGen_.insert(val);
-				}
-			}
-		}
-	}
-
-	void LiveIntervalAnalysis::computeGlobalLiveSet(IRFunction * func)
-	{
-		bool isChange = false;
-		do {
-			isChange = false;
-			for (auto block = func->rbegin(), e = func->rend();
-				block != e; ++block) {
-				BasicBlock *BB = *block;
-				size_t before = BB->liveOut_.size();
-				BB->liveOut_.clear();	 
-				for (auto *succ : BB->successors_) {
-					BB->liveOut_ += succ->liveIn_;
-				}
-				if (before != BB->liveOut_.size())
-					isChange = true;
-				
-				before = BB->liveIn_.size();
-				BB->liveIn_ = BB->liveGen_;
-				for (auto *val : BB->liveOut_) {
-					if (!BB->liveKill_.count(val))
-						BB->liveIn_.insert(val);
-				}
-				if (before != BB->liveIn_.size())
-					isChange = true;
-			}
-		} while (isChange);
-	}
+#include "LiveIntervalAnalysis.h"
+
+#include <deque>
+#include <algorithm>
+#include <unordered_map>
+#include <cassert>
+#include <iostream>
+
+#include "CFG.h"
+#include "Instruction.h"
+#include "IRModule.h"
+
+namespace script
+{
+namespace {
+#ifdef _DEBUG
+    static void dumpValue(Value *value)
+    {
+        if (value == nullptr)
+            return;
+        switch (value->get_subclass_id())
+        {
+        case Value::UndefVal:
+        {
+            std::cout << "[[Undef]]";
+            break;
+        }
+        case Value::ConstantVal:
+        {
+            std::cout << "[[Constant]]";;
+            break;
+        }
+        case Value::TableVal:
+        {
+            std::cout << "[[Table]]";
+            break;
+        }
+        case Value::UserClosureVal:
+        {
+            std::cout << "[function]:" <<
+				((UserClosure*)value)->getClosureName();
+            break;
+        }
+        case Value::ParamVal:
+        {
+            std::cout << "[Param]:" << ((Param*)value)->getParamName();
+            break;
+        }
+        case Value::InstructionVal:
+            std::cout << ((Instruction*)value)->get_value_name();
+            break;
+            //dump((Instruction*)value);
+        }
+    }
+#endif // _DEBUG
+}
+
+    void LiveIntervalAnalysis::runOnFunction(IRFunction *func)
+    {
+		func->computeBlockOrder();
+		numberValues(func);
+		computeLocalLiveSet(func);
+		computeGlobalLiveSet(func);
+
+#ifdef _DEBUG
+		std::cout << "Live analysis result:" << std::endl;
+		for (auto block = func->begin(), e = func->end();
+			block != e; ++block) {
+			BasicBlock *BB = *block;
+			std::cout << " " << BB->name_
+				<< "(" << BB->start_ 
+				<< ", " << BB->end_
+				<< "): " << std::endl;
+			std::cout << "  LiveIn = { ";
+			BB->liveIn_.forEach([this](size_t idx) {
+				dumpValue(index2val[idx]);
+				std::cout << ", ";
+			});
+			std::cout << "}\n  LiveOut = { ";
+			BB->liveOut_.forEach([this](size_t idx) {
+				dumpValue(index2val[idx]);
+				std::cout << ", ";
+			});
+			std::cout << "}\n  LiveGen = { ";
+			BB->liveGen_.forEach([this](size_t idx) {
+				dumpValue(index2val[idx]);
+				std::cout << ", ";
+			});
+			std::cout << "}\n  LiveKill = { ";
+			BB->liveKill_.forEach([this](size_t idx) {
+				dumpValue(index2val[idx]);
+				std::cout << ", ";
+			});
+			std::cout << "}\n" << std::endl;
+		}
+#endif // _DEBUG
+
+        buildIntervals(func);
+
+#ifdef _DEBUG
+		std::cout << "Begin dump intervals of function: "
+			<< func->getFunctionName() << std::endl;
+		for (auto &interval : intervals) {
+			std::cout << "    ";
+			dumpValue(interval.reg);
+			for (auto &range : interval.ranges) {
+				std::cout << " [" << range.start
+					<< ", " << range.end << ") ";
+			}
+			std::cout << std::endl;
+		}
+#endif // _DEBUG
+
+    }
+
+	LiveInterval *LiveIntervalAnalysis::getInterval(Value *val)
+    {
+        auto res = val2inter.find(val);
+        if (res == val2inter.end()) 
+        {
+            intervals.push_back({ val });
+			LiveInterval *I = &intervals.back();
+			val2inter.insert({ val, I });
+            return I;
+        }
+        return res->second;
+    }
+
+    void LiveIntervalAnalysis::buildIntervals(IRFunction *func) 
+    {
+        // The iteration is in reverse order so that all uses of 
+        // a virtual register are seen before its deﬁnition.
+		for (auto block = func->rbegin(), e = func->rend();
+			block != e; ++block) {
+			BasicBlock *BB = *block;
+			unsigned from = BB->getStart();
+			unsigned to = BB->getEnd();
+
+			BB->liveOut_.forEach([&](size_t idx) {
+				getInterval(index2val[idx])->addRange({ from, to });
+			});
+			
+			for (auto instr = BB->instr_rbegin();
+				instr != BB->instr_rend();
+				++instr) {
+				Instruction *I = *instr;
+
+				if (I->is_output()) {
+					LiveInterval *interval = getInterval(I);
+					//if (interval->empty())
+					//	interval->addRange({ I->getID(), to });
+					interval->setStart(I->getID());
+					interval->addUsePosition(I->getID());
+				}
+
+				// phi operands are covered by the live out of their
+				// incoming blocks.
+				if (I->is_phi_node())
+					continue;
+
+				for (auto op = I->op_begin();
+					op != I->op_end();
+					++op) {
+					Value *val = op->get_value();
+					if (val->is_value())
+						continue;
+
+					LiveInterval *interval = getInterval(val);
+					interval->addRange({ from, I->getID() + 2 });
+					interval->addUsePosition(I->getID());
+				}
+			}
+        }
+
+		// positions were added from the back.
+		for (auto &interval : intervals) {
+			std::reverse(interval.usePositions.begin(),
+				interval.usePositions.end());
+		}
+    }
+
+    void LiveIntervalAnalysis::swapIntervals(
+		std::list<LiveInterval> &to)
+    {
+        val2inter.clear();
+        std::swap(this->intervals, to);
+    }
+
+	//
+	// instruction IDs step by two from zero in block order, so ID / 2 
+	// numbers every value defined in the function densely.
+	void LiveIntervalAnalysis::numberValues(IRFunction *func)
+	{
+		index2val.clear();
+		for (auto block = func->begin(), e = func->end();
+			block != e; ++block) {
+			for (auto instr = (*block)->instr_begin();
+				instr != (*block)->instr_end();
+				++instr) {
+				Instruction *I = *instr;
+				assert(I->getID() >> 1 == index2val.size());
+				index2val.push_back(I);
+			}
+		}
+	}
+
+	// false for constants, params and values of dropped blocks.
+	bool LiveIntervalAnalysis::liveIndexOf(Value *val, size_t &index) const
+	{
+		if (!val->is_instr())
+			return false;
+		index = static_cast<Instruction*>(val)->getID() >> 1;
+		return index < index2val.size() && index2val[index] == val;
+	}
+
+	void LiveIntervalAnalysis::computeLocalLiveSet(IRFunction *func)
+	{
+		size_t numOfValues = index2val.size();
+		for (auto block = func->begin(), e = func->end();
+			block != e; ++block) {
+			BasicBlock *BB = *block;
+			BB->liveGen_.resize(numOfValues);
+			BB->liveKill_.resize(numOfValues);
+			for (auto instr = BB->instr_begin();
+				instr != BB->instr_end();
+				++instr) {
+				Instruction *I = *instr;
+				if (I->is_output())
+					BB->liveKill_.set(I->getID() >> 1);
+				if (I->is_phi_node())
+					continue;
+				for (auto op = I->op_begin();
+					op != I->op_end();
+					++op) {
+					size_t index;
+					if (!liveIndexOf(op->get_value(), index))
+						continue;
+					if (!BB->liveKill_.test(index))
+						BB->liveGen_.set(index);
+				}
+			}
+		}
+
+		// a phi reads each operand at the end of its incoming block,
+		// on that edge only.
+		for (auto block = func->begin(), e = func->end();
+			block != e; ++block)
+			(*block)->liveOut_.resize(numOfValues);
+		for (auto block = func->begin(), e = func->end();
+			block != e; ++block) {
+			for (auto P = (*block)->phi_begin();
+				P != (*block)->phi_end();
+				++P) {
+				Phi *phi = *P;
+				for (size_t i = 0; i < phi->get_num_operands(); ++i) {
+					BasicBlock *incoming = phi->getIncomingBlock(i);
+					size_t index;
+					// blocks out of the order are unreachable.
+					if (incoming->liveOut_.size() != numOfValues
+						|| !liveIndexOf(phi->get_operand(i), index))
+						continue;
+					incoming->liveOut_.set(index);
+				}
+			}
+		}
+	}
+
+	//
+	// backward dataflow over a worklist seeded in reverse block order,
+	// a block is revisited only when the live in of a successor grows.
+	void LiveIntervalAnalysis::computeGlobalLiveSet(IRFunction * func)
+	{
+		std::unordered_map<BasicBlock*, bool> queued;
+		std::deque<BasicBlock*> worklist;
+		for (auto block = func->rbegin(), e = func->rend();
+			block != e; ++block) {
+			BasicBlock *BB = *block;
+			BB->liveIn_ = BB->liveGen_;
+			worklist.push_back(BB);
+			queued[BB] = true;
+		}
+
+		while (!worklist.empty()) {
+			BasicBlock *BB = worklist.front();
+			worklist.pop_front();
+			queued[BB] = false;
+
+			for (auto *succ : BB->successors_) 
+				BB->liveOut_.unionWith(succ->liveIn_);
+			if (!BB->liveIn_.unionWithDifference(
+				BB->liveOut_, BB->liveKill_))
+				continue;
+
+			for (auto *pred : BB->precursors_) {
+				auto iter = queued.find(pred);
+				// blocks out of the order are unreachable.
+				if (iter == queued.end() || iter->second)
+					continue;
+				iter->second = true;
+				worklist.push_back(pred);
+			}
+		}
+	}
 }
\ No newline at end of file
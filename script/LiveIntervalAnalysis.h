@@ -1,34 +1,38 @@
-#pragma once
-
-#include <list>
-#include <set>
-#include <map>
-
-#include "LiveInterval.h"
-#include "Pass.h"
-
-namespace script
-{
-    class Value;
-    class BasicBlock;
-
-    class LiveIntervalAnalysis : public FunctionPass
-    {
-    public:
-        virtual ~LiveIntervalAnalysis() = default;
-
-        virtual void runOnFunction(IRFunction *func);
-        
-        void swapIntervals(std::list<LiveInterval> &to);
-
-    private:
-		void buildIntervals(IRFunction *func);
-		void computeLocalLiveSet(IRFunction *func);
-		void computeGlobalLiveSet(IRFunction *func);
-
-		LiveInterval *getInterval(Value *val);
-
-        std::list<LiveInterval>         intervals;
-        std::map<Value*, LiveInterval*> val2inter;
-    };
+#pragma once
+
+#include <list>
+#include <map>
+#include <vector>
+
+#include "LiveInterval.h"
+#include "Pass.h"
+
+namespace script
+{
+    class Value;
+    class BasicBlock;
+
+    class LiveIntervalAnalysis : public FunctionPass
+    {
+    public:
+        virtual ~LiveIntervalAnalysis() = default;
+
+        virtual void runOnFunction(IRFunction *func);
+        
+        void swapIntervals(std::list<LiveInterval> &to);
+
+    private:
+		void buildIntervals(IRFunction *func);
+		void numberValues(IRFunction *func);
+		void computeLocalLiveSet(IRFunction *func);
+		void computeGlobalLiveSet(IRFunction *func);
+
+		LiveInterval *getInterval(Value *val);
+		bool liveIndexOf(Value *val, size_t &index) const;
+
+        std::list<LiveInterval>         intervals;
+        std::map<Value*, LiveInterval*> val2inter;
+		// instructions by ID / 2, the index of their live bits.
+		std::vector<Value*>             index2val;
+    };
 }
\ No newline at end of file
@@ -0,0 +1,232 @@
+#include "OpDecoder.h"
+
+#include <cassert>
+#include <vector>
+
+#include "opcode.h"
+#include "OpcodeModule.h"
+
+namespace script
+{
+namespace
+{
+	uint16_t ReadRegister(
+		const std::vector<Byte> &codes, 
+		size_t &ip)
+	{
+		uint16_t result = (unsigned char)codes[ip++];
+		result = (result << 8) | (unsigned char)codes[ip++];
+		return result;
+	}
+
+	int32_t ReadInteger(
+		const std::vector<Byte> &codes, 
+		size_t &ip)
+	{
+		int32_t result = 0;
+		for (int i = 0; i < 4; ++i)
+		{
+			result <<= 8;
+			result |= (unsigned char)codes[ip++];
+		}
+		return result;
+	}
+}
+
+	size_t OpDecoder::LengthOf(int8_t op)
+	{
+		switch (op)
+		{
+		case OK_Halt:
+		case OK_ReturnN:
+			return 1;
+		case OK_MoveN:
+		case OK_Param:
+		case OK_Return:
+			return 3;
+		case OK_Goto:
+		case OK_Not:
+		case OK_Move:
+			return 5;
+		case OK_Add:
+		case OK_Sub:
+		case OK_Mul:
+		case OK_Div:
+		case OK_Great:
+		case OK_GreatThan:
+		case OK_Less:
+		case OK_LessThan:
+		case OK_Equal:
+		case OK_NotEqual:
+		case OK_Index:
+		case OK_SetIndex:
+		case OK_MoveS:
+		case OK_MoveI:
+		case OK_Load:
+		case OK_Store:
+		case OK_If:
+		case OK_UserClosure:
+			return 7;
+		case OK_AddImm:
+		case OK_SubImm:
+		case OK_GreatImm:
+		case OK_GreatThanImm:
+		case OK_LessImm:
+		case OK_LessThanImm:
+		case OK_EqualImm:
+		case OK_NotEqualImm:
+		case OK_Call:
+		case OK_TailCall:
+		case OK_JumpIfGreat:
+		case OK_JumpIfGreatThan:
+		case OK_JumpIfLess:
+		case OK_JumpIfLessThan:
+		case OK_JumpIfEqual:
+		case OK_JumpIfNotEqual:
+		case OK_JumpUnlessGreat:
+		case OK_JumpUnlessGreatThan:
+		case OK_JumpUnlessLess:
+		case OK_JumpUnlessLessThan:
+			return 9;
+		case OK_MoveL:
+		case OK_MoveF:
+		case OK_NewClosure:
+		case OK_NewHash:
+			return 11;
+		}
+		assert(0 && "unknown opcode");
+		return 1;
+	}
+
+	void OpDecoder::Decode(OpcodeFunction &func)
+	{
+		const std::vector<Byte> &codes = func.codes;
+
+		// map byte offsets to instruction indices, the extra
+		// entry lets a jump target the end of the function.
+		std::vector<int32_t> indexOf(codes.size() + 1, -1);
+		int32_t count = 0;
+		for (size_t ip = 0; ip < codes.size(); ip += LengthOf(codes[ip]))
+			indexOf[ip] = count++;
+		indexOf[codes.size()] = count;
+
+		auto target = [&indexOf](int32_t offset) {
+			assert(offset >= 0 && (size_t)offset < indexOf.size());
+			assert(indexOf[offset] >= 0 && "jump into an instruction");
+			return indexOf[offset];
+		};
+
+		std::vector<DecodedInstr> &decoded = func.decoded;
+		decoded.clear();
+		func.callCaches.clear();
+		decoded.reserve(count + 1);
+
+		size_t ip = 0;
+		while (ip < codes.size())
+		{
+			DecodedInstr instr = { 0, 0, 0, 0, 0, 0 };
+			instr.op = (uint8_t)codes[ip++];
+			switch (instr.op)
+			{
+			case OK_Add:
+			case OK_Sub:
+			case OK_Mul:
+			case OK_Div:
+			case OK_Great:
+			case OK_GreatThan:
+			case OK_Less:
+			case OK_LessThan:
+			case OK_Equal:
+			case OK_NotEqual:
+			case OK_Index:
+			case OK_SetIndex:
+				instr.a = ReadRegister(codes, ip);
+				instr.b = ReadRegister(codes, ip);
+				instr.c = ReadRegister(codes, ip);
+				break;
+			case OK_AddImm:
+			case OK_SubImm:
+			case OK_GreatImm:
+			case OK_GreatThanImm:
+			case OK_LessImm:
+			case OK_LessThanImm:
+			case OK_EqualImm:
+			case OK_NotEqualImm:
+				instr.a = ReadRegister(codes, ip);
+				instr.b = ReadRegister(codes, ip);
+				instr.imm = ReadInteger(codes, ip);
+				break;
+			case OK_Not:
+			case OK_Move:
+				instr.a = ReadRegister(codes, ip);
+				instr.b = ReadRegister(codes, ip);
+				break;
+			case OK_MoveN:
+			case OK_Param:
+			case OK_Return:
+				instr.a = ReadRegister(codes, ip);
+				break;
+			case OK_MoveS:
+			case OK_MoveI:
+			case OK_Load:
+			case OK_Store:
+			case OK_UserClosure:
+				instr.a = ReadRegister(codes, ip);
+				instr.imm = ReadInteger(codes, ip);
+				break;
+			case OK_Goto:
+				instr.imm = target(ReadInteger(codes, ip));
+				break;
+			case OK_If:
+				instr.a = ReadRegister(codes, ip);
+				instr.imm = target(ReadInteger(codes, ip));
+				break;
+			case OK_JumpIfGreat:
+			case OK_JumpIfGreatThan:
+			case OK_JumpIfLess:
+			case OK_JumpIfLessThan:
+			case OK_JumpIfEqual:
+			case OK_JumpIfNotEqual:
+			case OK_JumpUnlessGreat:
+			case OK_JumpUnlessGreatThan:
+			case OK_JumpUnlessLess:
+			case OK_JumpUnlessLessThan:
+				instr.a = ReadRegister(codes, ip);
+				instr.b = ReadRegister(codes, ip);
+				instr.imm = target(ReadInteger(codes, ip));
+				break;
+			case OK_Call:
+				instr.a = ReadRegister(codes, ip);
+				instr.b = ReadRegister(codes, ip);
+				instr.imm = ReadInteger(codes, ip);
+				instr.ext = func.callCaches.size();
+				func.callCaches.push_back({ nullptr, 0, 0, nullptr });
+				break;
+			case OK_TailCall:
+				instr.a = ReadRegister(codes, ip);
+				instr.b = ReadRegister(codes, ip);
+				instr.imm = ReadInteger(codes, ip);
+				break;
+			case OK_MoveL:	// imm:ext are the high and low words
+			case OK_MoveF:	// imm:ext are the bits of double
+			case OK_NewClosure:
+			case OK_NewHash:	// imm, ext are the expected sizes
+				instr.a = ReadRegister(codes, ip);
+				instr.imm = ReadInteger(codes, ip);
+				instr.ext = ReadInteger(codes, ip);
+				break;
+			case OK_Halt:
+			case OK_ReturnN:
+				break;
+			default:
+				assert(0 && "unknown opcode");
+				break;
+			}
+			decoded.push_back(instr);
+		}
+
+		// never run off the end of the stream.
+		DecodedInstr halt = { OK_Halt, 0, 0, 0, 0, 0 };
+		decoded.push_back(halt);
+	}
+}
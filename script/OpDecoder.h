@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace script
+{
+	struct OpcodeFunction;
+
+	//
+	// Translate the big-endian byte stream of a function into
+	// the DecodedInstr stream consumed by the VM.
+	class OpDecoder
+	{
+	public:
+		static void Decode(OpcodeFunction &func);
+
+	private:
+		static size_t LengthOf(int8_t op);
+	};
+}
@@ -1,54 +1,114 @@
-#include "OpcodeModule.h"
-
-#include <cassert>
-
-namespace script
-{
-    OpcodeModule::~OpcodeModule()
-    {
-    }
-
-    size_t OpcodeModule::push_string(const std::string & str)
-    {
-		size_t idx = stringPool_.size();
-		if (stringMap_.count(str)) {
-			return stringMap_[str];
-		}
-		stringPool_.push_back(str);
-		stringMap_.insert({ str, idx });
-		return idx;
-    }
-
-    const std::string & OpcodeModule::getString(size_t idx)
-    {
-		assert(stringPool_.size() > idx);
-        return stringPool_[idx];
-    }
-
-    OpcodeFunction & OpcodeModule::getFunction(const std::string &name)
-    {
-		size_t idx = push_string(name);
-		if (!functions_.count(idx)) {
-			auto &func = functions_[idx];
-			func.name = idx;
-			return func;
-		}
-        return functions_[idx];
-    }
-
-	UserDefClosure OpcodeModule::getUserClosure(const std::string & name)
-	{
-		size_t idx = push_string(name);
-		if (!userClosure_.count(idx)) {
-			return nullptr;
-		}
-		return userClosure_[idx];
-	}
-
-	void OpcodeModule::pushUserClosure(
-		const std::string & name, UserDefClosure closure)
-	{
-		size_t idx = push_string(name);
-		userClosure_[idx] = closure;
-	}
+#include "OpcodeModule.h"
+
+#include <cassert>
+
+#include "OpDecoder.h"
+
+namespace script
+{
+    OpcodeModule::~OpcodeModule()
+    {
+    }
+
+    size_t OpcodeModule::push_string(const std::string & str)
+    {
+		size_t idx = stringPool_.size();
+		if (stringMap_.count(str)) {
+			return stringMap_[str];
+		}
+		stringPool_.push_back(str);
+		stringMap_.insert({ str, idx });
+		return idx;
+    }
+
+    const std::string & OpcodeModule::getString(size_t idx)
+    {
+		assert(stringPool_.size() > idx);
+        return stringPool_[idx];
+    }
+
+    OpcodeFunction & OpcodeModule::getFunction(const std::string &name)
+    {
+		size_t idx = push_string(name);
+		if (!functions_.count(idx)) {
+			auto &func = functions_[idx];
+			func.name = idx;
+			return func;
+		}
+        return functions_[idx];
+    }
+
+	UserDefClosure OpcodeModule::getUserClosure(const std::string & name)
+	{
+		size_t idx = push_string(name);
+		if (!userClosure_.count(idx)) {
+			return nullptr;
+		}
+		return userClosure_[idx];
+	}
+
+	void OpcodeModule::pushUserClosure(
+		const std::string & name, UserDefClosure closure)
+	{
+		size_t idx = push_string(name);
+		userClosure_[idx] = closure;
+	}
+
+	void OpcodeModule::link()
+	{
+		for (auto &func : functions_) {
+			if (!func.second.decoded.empty())
+				continue;
+			OpDecoder::Decode(func.second);
+			resolve(func.second);
+		}
+	}
+
+	void OpcodeModule::resolve(OpcodeFunction &func)
+	{
+		for (auto &instr : func.decoded) {
+			if (instr.op == OK_NewClosure)
+				instr.imm = functionIndex(instr.imm);
+			else if (instr.op == OK_UserClosure)
+				instr.imm = userClosureIndex(instr.imm);
+			else if (instr.op == OK_MoveS)
+				instr.imm = literalIndex(instr.imm);
+		}
+	}
+
+	size_t OpcodeModule::functionIndex(size_t name)
+	{
+		auto iter = functionIndex_.find(name);
+		if (iter != functionIndex_.end())
+			return iter->second;
+
+		size_t idx = functionTable_.size();
+		functionTable_.push_back(&getFunction(getString(name)));
+		functionIndex_.insert({ name, idx });
+		return idx;
+	}
+
+	size_t OpcodeModule::userClosureIndex(size_t name)
+	{
+		auto iter = userClosureIndex_.find(name);
+		if (iter != userClosureIndex_.end())
+			return iter->second;
+
+		size_t idx = userClosureTable_.size();
+		userClosureTable_.push_back(getUserClosure(getString(name)));
+		userClosureIndex_.insert({ name, idx });
+		return idx;
+	}
+
+	size_t OpcodeModule::literalIndex(size_t str)
+	{
+		auto iter = literalIndex_.find(str);
+		if (iter != literalIndex_.end())
+			return iter->second;
+
+		size_t idx = literalTable_.size();
+		literalTable_.push_back(str);
+		literalIndex_.insert({ str, idx });
+		return idx;
+	}
 }
\ No newline at end of file
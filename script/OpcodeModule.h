@@ -1,49 +1,96 @@
-#pragma once
-
-#include "opcode.h"
-
-#include <set>
-#include <vector>
-#include <map>
-#include <unordered_map>
-
-namespace script
-{
-    struct Opcodes
-    {
-		size_t numOfregisters;
-		std::vector<size_t> params;
-		std::vector<Byte> codes;
-    };
-
-    struct OpcodeFunction : public Opcodes
-    {
-        size_t name;
-		size_t paramSize;
-		size_t codeIndex;
-    };
-
-	class VMState;
-	typedef Object(*UserDefClosure)(VMState*, size_t);
-
-    class OpcodeModule : public Opcodes
-    {
-		friend class DumpOpcode;
-    public:
-        ~OpcodeModule();
-
-		OpcodeFunction &getFunction(const std::string &name);
-		UserDefClosure getUserClosure(const std::string &name);
-		void pushUserClosure(const std::string &name, 
-			UserDefClosure closure);
-        size_t push_string(const std::string &str);
-        const std::string &getString(size_t idx);
-
-        size_t string_size() const { return stringPool_.size(); }
-    protected:
-		std::vector<std::string> stringPool_;
-        std::unordered_map<std::string, const size_t> stringMap_;
-        std::map<size_t, OpcodeFunction> functions_;
-		std::map<size_t, UserDefClosure> userClosure_;
-    };
+#pragma once
+
+#include "opcode.h"
+
+#include <set>
+#include <vector>
+#include <map>
+#include <unordered_map>
+
+namespace script
+{
+    struct Opcodes
+    {
+		size_t numOfregisters;
+		std::vector<size_t> params;
+		std::vector<Byte> codes;
+    };
+
+	struct OpcodeFunction;
+
+	//
+	// Inline cache of an OK_Call site, indexed by DecodedInstr::ext.
+	// hold and total are the arity split of the last closure called,
+	// builtin is the function of the last user closure instead.
+	struct CallCache
+	{
+		const OpcodeFunction *target;
+		size_t hold;
+		size_t total;
+		void *builtin;
+	};
+
+    struct OpcodeFunction : public Opcodes
+    {
+        size_t name;
+		size_t paramSize;
+		size_t codeIndex;
+		// rewritten in place by quickening.
+		mutable std::vector<DecodedInstr> decoded;
+		mutable std::vector<CallCache> callCaches;
+    };
+
+	class VMState;
+	typedef Object(*UserDefClosure)(VMState*, const Object*, size_t);
+
+    class OpcodeModule : public Opcodes
+    {
+		friend class DumpOpcode;
+    public:
+        ~OpcodeModule();
+
+		OpcodeFunction &getFunction(const std::string &name);
+		UserDefClosure getUserClosure(const std::string &name);
+		void pushUserClosure(const std::string &name, 
+			UserDefClosure closure);
+        size_t push_string(const std::string &str);
+        const std::string &getString(size_t idx);
+
+		// decode functions generated since the last call and resolve
+		// their closure operands into the tables below.
+		void link();
+
+		OpcodeFunction *functionAt(size_t idx) const {
+			return functionTable_[idx];
+		}
+		UserDefClosure userClosureAt(size_t idx) const {
+			return userClosureTable_[idx];
+		}
+
+		// string constants used by OK_MoveS, in literal index order.
+		size_t literal_size() const { return literalTable_.size(); }
+		const std::string &getLiteral(size_t idx) {
+			return getString(literalTable_[idx]);
+		}
+
+        size_t string_size() const { return stringPool_.size(); }
+    protected:
+		void resolve(OpcodeFunction &func);
+		size_t functionIndex(size_t name);
+		size_t userClosureIndex(size_t name);
+		size_t literalIndex(size_t str);
+
+		std::vector<std::string> stringPool_;
+        std::unordered_map<std::string, const size_t> stringMap_;
+        std::map<size_t, OpcodeFunction> functions_;
+		std::map<size_t, UserDefClosure> userClosure_;
+
+		// dense tables built by link, keyed by string index.
+		std::vector<OpcodeFunction*> functionTable_;
+		std::vector<UserDefClosure> userClosureTable_;
+		std::unordered_map<size_t, size_t> functionIndex_;
+		std::unordered_map<size_t, size_t> userClosureIndex_;
+		std::vector<size_t> literalTable_;
+		std::unordered_map<size_t, size_t> literalIndex_;
+    };
 }
\ No newline at end of file
@@ -1,230 +1,481 @@
-#include "RegisterAllocation.h"
-
-#include <climits>
-#include <algorithm>
-
-#include "CFG.h"
-#include "IRModule.h"
-#include "Instruction.h"
-#include "MachineRegister.h"
-
-namespace script
-{
-    RegisterAllocator::RegisterAllocator(
-		unsigned regNums, std::list<LiveInterval> &list)
-        : RegisterNums(regNums)
-		, intervals(list)
-    {
-    }
-
-    void RegisterAllocator::initAndSortIntervals()
-    {
-		for (auto &interval : intervals) {
-			unhandleSet.insert(&interval);
-			V2L.insert({ interval.reg, &interval });
-		}
-    }
-
-	void RegisterAllocator::resolveDataFlow(IRFunction *func)
-	{
-		MoveResolve resolver;
-		for (auto *from : *func) {
-			for (size_t i = 0; i < from->numOfSuccessors(); ++i) {
-				BasicBlock *to = from->successor(i);
-				// collect all resolving moves necessary between the 
-				// block from and to 
-				for (auto *value : to->liveIn_) {
-					assert(value->is_instr());
-					Instruction *I = static_cast<Instruction*>(value);
-					LiveInterval *parent = V2L[value];
-					LiveInterval *fromInterval = parent->childAt(from->back()->getID());
-					LiveInterval *toInterval = parent->childAt(to->front()->getID());
-					if (fromInterval != toInterval) {
-						resolver.addMapping(fromInterval, toInterval);
-					}
-				}
-				// the moves are inserted either at the end of block from 
-				// or at the beginning of block to, depending on the control flow.
-				resolver.findInsertPosition(from, to);
-
-				// insert all moves in correct order 
-				resolver.resolverMappings();
-			}
-		}
-	}
-
-	void RegisterAllocator::splitLiveIntervalAt(
-		LiveInterval &interval, unsigned op)
-	{
-		LiveInterval tmp{ interval.reg };
-	}
-
-	void RegisterAllocator::splitLiveIntervalBefore(
-		LiveInterval &interval, unsigned op)
-	{
-		LiveInterval tmp{ interval.reg };
-		auto removeRanges = [op, &tmp](LiveRange &range) {
-			if (range.contains(op)) {
-				tmp.addRange({ op, range.end });
-				range.setEnd(op);
-				return false;
-			}
-			else if (op > range.end)
-				return false;
-			tmp.addRange(range);
-			return true;
-		};
-		interval.ranges.remove_if(removeRanges);
-
-		auto use = std::lower_bound(interval.usePositions.begin(),
-			interval.usePositions.end(), op);
-		tmp.usePositions.assign(use, interval.usePositions.end());
-		interval.usePositions.erase(use, interval.usePositions.end());
-		if (interval.isSplitParent())
-			tmp.setSplitParent(&interval);
-		else
-			tmp.setSplitParent(interval.getSplitParent());
-		intervals.push_back(tmp);
-		unhandleSet.insert(&intervals.back());
-	}
-
-    void RegisterAllocator::runOnFunction(IRFunction *func) 
-    {
-        linearScanAllocate(func);
-    }
-
-    void RegisterAllocator::linearScanAllocate(IRFunction *func)
-    {   
-		initAndSortIntervals();
-        while (!unhandleSet.empty()) {
-			auto beg = unhandleSet.begin();
-			LiveInterval &interval = **unhandleSet.begin();
-            // expired Old Intervals.
-			expiredOldIntervals(interval);
-			if (tryAllocateFreeReg(interval)) {
-				allocateBlockedReg(interval);
-			}
-
-			if (interval.isAssignReg())
-				active.insert(&interval);
-			unhandleSet.erase(&interval);
-        }
-		resolveDataFlow(func);
-    }
-
-	void RegisterAllocator::assignRegNum(IRFunction * func)
-	{
-		for (auto *block : *func) {
-			for (auto instr = block->instr_begin();
-				instr != block->instr_end();
-				++instr) {
-				Instruction *I = *instr;
-				if (I->is_output()) {
-					unsigned reg = V2L[I]->childAt(I->getID())->assignedReg;
-					I->setOutputReg({ reg });
-				}
-				for (auto op = I->op_begin();
-					op != I->op_end();
-					++op) {
-					Value *val = op->get_value();
-					if (val->is_value())
-						continue;
-					Instruction *I = static_cast<Instruction*>(val);
-					unsigned reg = V2L[I]->childAt(I->getID())->assignedReg;
-					I->pushInputReg({ reg });
-				}
-			}
-		}
-	}
-
-	bool RegisterAllocator::tryAllocateFreeReg(LiveInterval &interval)
-	{
-		std::vector<unsigned> freePos(RegisterNums, INT_MAX);
-
-		for (auto *I : active) {
-			freePos[I->getAssignReg()] = 0;
-		}
-
-		for (auto *I : inactive) {
-			if (I->overlaps(interval)) {
-				auto iter = I->advanceTo(
-					I->begin(), interval.beginNumber());
-				freePos[I->getAssignReg()] = std::min(
-					iter->start, freePos[I->getAssignReg()]);
-			}
-		}
-
-		auto reg = std::max_element(freePos.begin(), freePos.end());
-		if (freePos[*reg] == 0)
-			// allocation failed, no register available without spilling.
-			return false;
-		else if (freePos[*reg] > interval.endNumber())
-			// register available for whole current.
-			interval.assignedReg = *reg;
-		else {
-			// register available for first part of current.
-			interval.assignedReg = *reg;
-			splitLiveIntervalBefore(interval, freePos[*reg]);
-		}
-		return true;
-	}
-
-	void RegisterAllocator::allocateBlockedReg(LiveInterval &interval)
-	{
-		std::vector<unsigned> nextUsePos(RegisterNums, INT_MAX);
-		std::vector<LiveInterval*> values(RegisterNums);
-
-		unsigned pos = interval.beginNumber();
-		for (auto *I : active) {
-			if (nextUsePos[I->getAssignReg()] > I->nextUseAfter(pos)) {
-				values[I->getAssignReg()] = I;
-			}
-		}
-
-		for (auto *I : inactive) {
-			if (!I->overlaps(interval)) 
-				continue;
-			if (nextUsePos[I->getAssignReg()] > I->nextUseAfter(pos)) {
-				values[I->getAssignReg()] = I;
-			}
-		}
-
-		auto reg = std::max_element(nextUsePos.begin(), nextUsePos.end());
-		if (interval.firstUse() > nextUsePos[*reg]) {
-			// all other intervals are used before current, 
-			// so it is best to spill current itself
-			// TODO: assign spill slot to current
-			splitLiveIntervalBefore(interval, interval.firstUse());
-		}
-		else {
-			interval.assignedReg = *reg;
-			splitLiveIntervalAt(interval, interval.beginNumber());
-			splitLiveIntervalAt(*values[*reg], interval.beginNumber());
-		}
-	}
-
-	void RegisterAllocator::expiredOldIntervals(LiveInterval & interval)
-	{
-		ActiveSet newActive;
-		ActiveSet newInactive;
-		for (auto *I : active) {
-			if (I->endNumber() < interval.beginNumber())
-				continue;
-			else if (!I->liveAt(interval.beginNumber()))
-				newInactive.insert(I);
-			else
-				newActive.insert(I);
-		};
-		for (auto *I : inactive) {
-			if (I->endNumber() < interval.beginNumber())
-				continue;
-			else if (I->liveAt(interval.beginNumber()))
-				newActive.insert(I);
-			else
-				newInactive.insert(I);
-		}
-		std::swap(newActive, active);
-		std::swap(newInactive, inactive);
-	}
-
-}
\ No newline at end of file
+#include "RegisterAllocation.h"
+
+#include <climits>
+#include <algorithm>
+#include <unordered_map>
+
+#include "CFG.h"
+#include "IRModule.h"
+#include "IRContext.h"
+#include "Instruction.h"
+#include "MachineRegister.h"
+
+namespace script
+{
+	void MoveResolve::addMapping(unsigned from, unsigned to)
+	{
+		if (from != to)
+			mappings.push_back({ from, to });
+	}
+
+	void MoveResolve::resolveMappings(Instruction *before,
+		const std::function<unsigned()> &scratch)
+	{
+		BasicBlock *block = before->get_parent();
+		auto iter = std::find(block->instr_begin(),
+			block->instr_end(), before);
+		assert(iter != block->instr_end());
+
+		auto emit = [iter](unsigned to, unsigned from) {
+			IRContext::insertAfter<Assign>(iter,
+				MachineRegister(to), MachineRegister(from));
+		};
+
+		while (!mappings.empty()) {
+			// a destination nobody reads any more can be written now.
+			auto ready = std::find_if(mappings.begin(), mappings.end(),
+				[this](const std::pair<unsigned, unsigned> &move) {
+				for (auto &other : mappings) {
+					if (other.first == move.second)
+						return false;
+				}
+				return true;
+			});
+			if (ready != mappings.end()) {
+				emit(ready->second, ready->first);
+				mappings.erase(ready);
+				continue;
+			}
+
+			// only cycles are left, park one source in scratch.
+			unsigned reg = scratch();
+			unsigned from = mappings.front().first;
+			emit(reg, from);
+			for (auto &move : mappings) {
+				if (move.first == from)
+					move.first = reg;
+			}
+		}
+	}
+
+    RegisterAllocator::RegisterAllocator(
+		unsigned regNums, std::list<LiveInterval> &list)
+        : RegisterNums(regNums)
+		, poolSize(0)
+		, totalReg(0)
+		, scratchReg(-1)
+		, intervals(list)
+    {
+    }
+
+	void RegisterAllocator::runOnFunction(IRFunction *func)
+	{
+		assert(func);
+
+		numberInstructions(func);
+		coalesceIntervals(func);
+		initAndSortIntervals();
+
+		poolSize = computeMaxLive();
+		totalReg = poolSize;
+		linearScanAllocate();
+
+		// instructions get their registers before any move is
+		// inserted, moves carry machine registers only.
+		assignRegNum(func);
+		resolveSplitMoves();
+		resolveDataFlow(func);
+
+		assert(totalReg < RegisterNums && "too many registers");
+	}
+
+	void RegisterAllocator::numberInstructions(IRFunction *func)
+	{
+		for (auto *block : *func) {
+			blockStarts.insert(block->getStart());
+			for (auto iter = block->instr_begin();
+				iter != block->instr_end(); ++iter) {
+				Instruction *instr = *iter;
+				size_t idx = instr->getID() / 2;
+				if (idx >= instrAt.size())
+					instrAt.resize(idx + 1, nullptr);
+				instrAt[idx] = instr;
+			}
+		}
+	}
+
+    void RegisterAllocator::initAndSortIntervals()
+    {
+		for (auto &interval : intervals) {
+			assert(!interval.empty());
+			unhandleSet.push(&interval);
+		}
+    }
+
+	//
+	// a phi and an operand, or an assign and its source, that never live
+	// at the same time share one interval, so the copy between them
+	// disappears. Merged values map to the interval which absorbed them.
+	void RegisterAllocator::coalesceIntervals(IRFunction *func)
+	{
+		for (auto &interval : intervals)
+			V2L.insert({ interval.reg, &interval });
+
+		std::unordered_map<LiveInterval*, LiveInterval*> leader;
+		auto find = [&leader](LiveInterval *interval) {
+			auto iter = leader.find(interval);
+			while (iter != leader.end()) {
+				interval = iter->second;
+				iter = leader.find(interval);
+			}
+			return interval;
+		};
+
+		auto tryJoin = [&](Value *to, Value *from) {
+			auto lhs = V2L.find(to), rhs = V2L.find(from);
+			if (lhs == V2L.end() || rhs == V2L.end())
+				return;
+			LiveInterval *dst = find(lhs->second);
+			LiveInterval *src = find(rhs->second);
+			if (dst == src || interferes(*dst, *src))
+				return;
+			dst->join(*src);
+			leader.insert({ src, dst });
+		};
+
+		for (auto *block : *func) {
+			for (auto iter = block->instr_begin();
+				iter != block->instr_end(); ++iter) {
+				Instruction *instr = *iter;
+				if (instr->is_phi_node()) {
+					Phi *phi = static_cast<Phi*>(instr);
+					for (size_t i = 0; i < phi->get_num_operands(); ++i)
+						tryJoin(phi, phi->get_operand(i));
+				}
+				else if (instr->is_assign()) {
+					tryJoin(instr, static_cast<Assign*>(instr)->get_value());
+				}
+			}
+		}
+
+		if (leader.empty())
+			return;
+		for (auto &pair : V2L)
+			pair.second = find(pair.second);
+		intervals.remove_if([](const LiveInterval &interval) {
+			return interval.empty();
+		});
+	}
+
+	bool RegisterAllocator::interferes(const LiveInterval &lhs,
+		const LiveInterval &rhs) const
+	{
+		auto i = lhs.begin(), ie = lhs.end();
+		auto j = rhs.begin(), je = rhs.end();
+		while (i != ie && j != je) {
+			if (i->end <= j->start)
+				++i;
+			else if (j->end <= i->start)
+				++j;
+			else if (!meetsAtDef(*i, *j) && !meetsAtDef(*j, *i))
+				return true;
+			else if (i->end < j->end)
+				++i;
+			else
+				++j;
+		}
+		return false;
+	}
+
+	// meetsAtDef - the two ranges only share the instruction which
+	// reads use for the last time and defines def. Every VM op reads
+	// its operands before it writes the result, so that is no conflict.
+	bool RegisterAllocator::meetsAtDef(const LiveRange &def,
+		const LiveRange &use) const
+	{
+		if (use.start >= def.start || use.end != def.start + 2
+			|| blockStarts.count(def.start))
+			return false;
+		Instruction *instr = instrAt[def.start / 2];
+		return instr && instr->is_output() && !instr->is_phi_node();
+	}
+
+	// computeMaxLive - the most intervals live at one position, the
+	// pool is never smaller, so it only splits where ranges have holes.
+	unsigned RegisterAllocator::computeMaxLive() const
+	{
+		std::vector<std::pair<unsigned, int>> events;
+		for (auto &interval : intervals) {
+			for (auto &range : interval) {
+				if (range.start >= range.end)
+					continue;
+				events.push_back({ range.start, 1 });
+				events.push_back({ range.end, -1 });
+			}
+		}
+		// ends sort before starts at the same position.
+		std::sort(events.begin(), events.end());
+
+		int live = 0, maxLive = 0;
+		for (auto &event : events) {
+			live += event.second;
+			maxLive = std::max(maxLive, live);
+		}
+		return static_cast<unsigned>(maxLive);
+	}
+
+	void RegisterAllocator::linearScanAllocate()
+	{
+		while (!unhandleSet.empty()) {
+			LiveInterval *current = unhandleSet.top();
+			unhandleSet.pop();
+
+			expiredOldIntervals(current->beginNumber());
+			if (!tryAllocateFreeReg(*current))
+				allocateBlockedReg(*current);
+
+			// slots past the pool belong to one interval only.
+			if ((unsigned)current->assignedReg < poolSize)
+				active.push_back(current);
+		}
+	}
+
+	void RegisterAllocator::expiredOldIntervals(unsigned position)
+	{
+		ActiveSet newActive, newInactive;
+		for (auto *I : active) {
+			if (I->expiredAt(position))
+				continue;
+			else if (I->liveAt(position))
+				newActive.push_back(I);
+			else
+				newInactive.push_back(I);
+		}
+		for (auto *I : inactive) {
+			if (I->expiredAt(position))
+				continue;
+			else if (I->liveAt(position))
+				newActive.push_back(I);
+			else
+				newInactive.push_back(I);
+		}
+		std::swap(newActive, active);
+		std::swap(newInactive, inactive);
+	}
+
+	bool RegisterAllocator::tryAllocateFreeReg(LiveInterval &interval)
+	{
+		if (poolSize == 0)
+			return false;
+
+		std::vector<unsigned> freeUntilPos(poolSize, UINT_MAX);
+		for (auto *I : active)
+			freeUntilPos[I->assignedReg] = 0;
+		for (auto *I : inactive) {
+			unsigned &pos = freeUntilPos[I->assignedReg];
+			pos = std::min(pos, I->firstIntersection(interval));
+		}
+
+		auto reg = std::max_element(
+			freeUntilPos.begin(), freeUntilPos.end());
+		if (*reg == 0)
+			return false;
+
+		if (*reg >= interval.endNumber()) {
+			// register available for the whole interval.
+			interval.assignedReg = reg - freeUntilPos.begin();
+			return true;
+		}
+
+		// register available for the first part of interval, the
+		// rest goes back to unhandled.
+		unsigned splitPos;
+		if (!findSplitPos(interval, *reg, splitPos))
+			return false;
+		interval.assignedReg = reg - freeUntilPos.begin();
+		unhandleSet.push(splitLiveIntervalAt(interval, splitPos));
+		return true;
+	}
+
+	// allocateBlockedReg - every register of the pool is taken, the
+	// interval is spilled to a frame slot of its own. Slots are what
+	// every instruction addresses anyway, so no reload is needed.
+	void RegisterAllocator::allocateBlockedReg(LiveInterval &interval)
+	{
+		interval.assignedReg = totalReg++;
+	}
+
+	bool RegisterAllocator::findSplitPos(LiveInterval &interval,
+		unsigned maxPos, unsigned &splitPos) const
+	{
+		unsigned minPos = interval.beginNumber();
+
+		// moves at a block boundary are placed on its edges by
+		// resolveDataFlow, prefer the latest one.
+		auto block = blockStarts.upper_bound(maxPos);
+		if (block != blockStarts.begin() && *std::prev(block) > minPos) {
+			splitPos = *std::prev(block);
+			return true;
+		}
+
+		// phi nodes are copied on incoming edges, nothing can be
+		// inserted between them.
+		size_t idx = maxPos / 2;
+		if (idx < instrAt.size() && instrAt[idx]
+			&& instrAt[idx]->is_phi_node())
+			return false;
+
+		splitPos = maxPos;
+		return maxPos > minPos;
+	}
+
+	LiveInterval *RegisterAllocator::splitLiveIntervalAt(
+		LiveInterval &interval, unsigned op)
+	{
+		intervals.push_back(LiveInterval(interval.reg));
+		LiveInterval *child = &intervals.back();
+		LiveInterval *parent = interval.isSplitParent()
+			? &interval : interval.getSplitParent();
+		child->setSplitParent(parent);
+		parent->splitChildren.push_back(child);
+
+		bool needMove = interval.liveAt(op) && !blockStarts.count(op);
+
+		auto range = interval.ranges.begin();
+		while (range != interval.ranges.end()) {
+			if (range->end <= op) {
+				++range;
+			}
+			else if (range->start < op) {
+				child->ranges.push_back({ op, range->end });
+				range->setEnd(op);
+				++range;
+			}
+			else {
+				child->ranges.push_back(*range);
+				range = interval.ranges.erase(range);
+			}
+		}
+
+		auto &uses = interval.usePositions;
+		auto use = std::lower_bound(uses.begin(), uses.end(), op);
+		child->usePositions.assign(use, uses.end());
+		uses.erase(use, uses.end());
+
+		if (needMove)
+			splitMoves.push_back({ op, &interval, child });
+		return child;
+	}
+
+	void RegisterAllocator::resolveSplitMoves()
+	{
+		std::stable_sort(splitMoves.begin(), splitMoves.end(),
+			[](const SplitMove &lhs, const SplitMove &rhs) {
+			return lhs.position < rhs.position;
+		});
+
+		auto scratch = [this]() { return scratchRegister(); };
+		for (size_t i = 0; i < splitMoves.size();) {
+			unsigned position = splitMoves[i].position;
+			MoveResolve resolver;
+			for (; i < splitMoves.size()
+				&& splitMoves[i].position == position; ++i) {
+				resolver.addMapping(splitMoves[i].from->assignedReg,
+					splitMoves[i].to->assignedReg);
+			}
+			if (!resolver.empty())
+				resolver.resolveMappings(instrAt[position / 2], scratch);
+		}
+	}
+
+	void RegisterAllocator::resolveDataFlow(IRFunction *func)
+	{
+		auto scratch = [this]() { return scratchRegister(); };
+		std::vector<BasicBlock*> blocks(func->begin(), func->end());
+		for (auto *from : blocks) {
+			for (size_t i = 0; i < from->numOfSuccessors(); ++i) {
+				BasicBlock *to = from->successor(i);
+				unsigned fromPos = from->getEnd() - 1;
+				unsigned toPos = to->getStart();
+
+				// collect all resolving moves necessary between the
+				// block from and to, phi copies are part of them.
+				MoveResolve resolver;
+				to->liveIn_.forEach([&](size_t idx) {
+					LiveInterval *parent = V2L[instrAt[idx]];
+					LiveInterval *src = parent->childAt(fromPos);
+					LiveInterval *dst = parent->childAt(toPos);
+					assert(src && dst);
+					resolver.addMapping(src->assignedReg,
+						dst->assignedReg);
+				});
+				addPhiMoves(from, to, resolver);
+				if (resolver.empty())
+					continue;
+
+				Instruction *before;
+				if (from->numOfSuccessors() == 1)
+					before = from->back();
+				else if (to->numOfPrecursors() == 1
+					&& !to->front()->is_phi_node())
+					before = to->front();
+				else
+					before = func->splitEdge(from, to)->back();
+				resolver.resolveMappings(before, scratch);
+			}
+		}
+	}
+
+	void RegisterAllocator::addPhiMoves(BasicBlock *from,
+		BasicBlock *to, MoveResolve &resolver)
+	{
+		unsigned fromPos = from->getEnd() - 1;
+		for (auto P = to->phi_begin(); P != to->phi_end(); ++P) {
+			Phi *phi = *P;
+			unsigned dst = locationAt(phi, phi->getID());
+			for (size_t i = 0; i < phi->get_num_operands(); ++i) {
+				Value *value = phi->get_operand(i);
+				if (phi->getIncomingBlock(i) != from || !V2L.count(value))
+					continue;
+				resolver.addMapping(locationAt(value, fromPos), dst);
+			}
+		}
+	}
+
+	void RegisterAllocator::assignRegNum(IRFunction *func)
+	{
+		for (auto *block : *func) {
+			for (auto iter = block->instr_begin();
+				iter != block->instr_end(); ++iter) {
+				Instruction *I = *iter;
+				unsigned op = I->getID();
+				if (I->is_output())
+					I->setOutputReg(locationAt(I, op));
+
+				// phi operands are copied on the incoming edges.
+				if (I->is_phi_node())
+					continue;
+				I->op_map([this, I, op](Value *val) {
+					if (!val->is_instr())
+						return;
+					I->pushInputReg(locationAt(val, op));
+				});
+			}
+		}
+	}
+
+	unsigned RegisterAllocator::locationAt(Value *value, unsigned op)
+	{
+		assert(V2L.count(value));
+		LiveInterval *parent = V2L[value];
+		LiveInterval *child = parent->childAt(op);
+		return (child ? child : parent)->assignedReg;
+	}
+
+	unsigned RegisterAllocator::scratchRegister()
+	{
+		if (scratchReg < 0)
+			scratchReg = totalReg++;
+		return scratchReg;
+	}
+}
@@ -1,70 +1,110 @@
-#pragma once
-
-#include <list>
-#include <map>
-#include <set>
-#include <vector>
-#include <queue>
-
-#include "LiveInterval.h"
-#include "Pass.h"
-
-namespace script
-{
-    class Value;
-    class BasicBlock;
-	class Instruction;
-	class MachineRegister;
-
-	class MoveResolve
-	{
-	public:
-		void addMapping(LiveInterval *from, LiveInterval *to) {}
-		void findInsertPosition(BasicBlock *from, BasicBlock *to) {}
-		void resolverMappings() {}
-	};
-
-    class RegisterAllocator : public FunctionPass
-    {
-    public:
-        RegisterAllocator(unsigned regNums, std::list<LiveInterval> &list);
-        virtual ~RegisterAllocator() = default;
-
-        void runOnFunction(IRFunction *func);
-
-    private:
-		struct IntervalEndCmp {
-			bool operator() (const LiveInterval *lhs, 
-				const LiveInterval *rhs) const {
-				return lhs->endNumber() < rhs->endNumber();
-			}
-		};
-		struct IntervalStartCmp {
-			bool operator() (const LiveInterval *lhs,
-				const LiveInterval *rhs) const {
-				return lhs->beginNumber() > rhs->beginNumber();
-			}
-		};
-		typedef std::set<LiveInterval*, IntervalEndCmp> ActiveSet;
-		typedef std::set<LiveInterval*, IntervalStartCmp> UnhandleSet;
-
-		void linearScanAllocate(IRFunction *func);
-		void assignRegNum(IRFunction *func);
-		void initAndSortIntervals();
-		void resolveDataFlow(IRFunction *func);
-		bool tryAllocateFreeReg(LiveInterval &interval);
-		void allocateBlockedReg(LiveInterval &interval);
-		void expiredOldIntervals(LiveInterval &interval);
-		void splitLiveIntervalAt(LiveInterval &interval, unsigned op);
-		void splitLiveIntervalBefore(LiveInterval &interval, unsigned op);
-	
-	private:
-        const unsigned RegisterNums;
-
-        std::list<LiveInterval> &intervals;
-		std::map<Value*, LiveInterval*> V2L;
-		ActiveSet active;
-		ActiveSet inactive;
-		UnhandleSet unhandleSet;
-	};
-}
\ No newline at end of file
+#pragma once
+
+#include <list>
+#include <map>
+#include <set>
+#include <vector>
+#include <queue>
+#include <functional>
+
+#include "LiveInterval.h"
+#include "Pass.h"
+
+namespace script
+{
+    class Value;
+    class BasicBlock;
+	class Instruction;
+	class MachineRegister;
+
+	//
+	// moves which take effect at the same point, they are emitted in
+	// an order which reads every source before it is overwritten.
+	//
+	class MoveResolve
+	{
+	public:
+		void addMapping(unsigned from, unsigned to);
+		bool empty() const { return mappings.empty(); }
+
+		// insert before instr, scratch is asked for a register
+		// only to break a cycle.
+		void resolveMappings(Instruction *before,
+			const std::function<unsigned()> &scratch);
+
+	private:
+		std::vector<std::pair<unsigned, unsigned>> mappings;
+	};
+
+    class RegisterAllocator : public FunctionPass
+    {
+    public:
+        RegisterAllocator(unsigned regNums, std::list<LiveInterval> &list);
+        virtual ~RegisterAllocator() = default;
+
+        void runOnFunction(IRFunction *func);
+
+		size_t totalRegister() const { return totalReg; }
+
+    private:
+		struct IntervalStartCmp {
+			bool operator() (const LiveInterval *lhs,
+				const LiveInterval *rhs) const {
+				if (lhs->beginNumber() != rhs->beginNumber())
+					return lhs->beginNumber() > rhs->beginNumber();
+				return lhs->endNumber() > rhs->endNumber();
+			}
+		};
+		typedef std::vector<LiveInterval*> ActiveSet;
+		typedef std::priority_queue<LiveInterval*,
+			std::vector<LiveInterval*>, IntervalStartCmp> UnhandleSet;
+
+		struct SplitMove {
+			unsigned position;
+			LiveInterval *from;
+			LiveInterval *to;
+		};
+
+		void numberInstructions(IRFunction *func);
+		void coalesceIntervals(IRFunction *func);
+		bool interferes(const LiveInterval &lhs,
+			const LiveInterval &rhs) const;
+		bool meetsAtDef(const LiveRange &def, const LiveRange &use) const;
+		void addPhiMoves(BasicBlock *from, BasicBlock *to,
+			MoveResolve &resolver);
+		unsigned computeMaxLive() const;
+		void linearScanAllocate();
+		void assignRegNum(IRFunction *func);
+		void initAndSortIntervals();
+		void resolveSplitMoves();
+		void resolveDataFlow(IRFunction *func);
+		bool tryAllocateFreeReg(LiveInterval &interval);
+		void allocateBlockedReg(LiveInterval &interval);
+		void expiredOldIntervals(unsigned position);
+		bool findSplitPos(LiveInterval &interval,
+			unsigned maxPos, unsigned &splitPos) const;
+		LiveInterval *splitLiveIntervalAt(
+			LiveInterval &interval, unsigned op);
+		unsigned locationAt(Value *value, unsigned op);
+		unsigned scratchRegister();
+
+	private:
+        const unsigned RegisterNums;
+		// registers [0, poolSize) are shared by linear scan, slots
+		// after them are handed out whole.
+		unsigned poolSize;
+		unsigned totalReg;
+		int scratchReg;
+
+        std::list<LiveInterval> &intervals;
+		std::map<Value*, LiveInterval*> V2L;
+		ActiveSet active;
+		ActiveSet inactive;
+		UnhandleSet unhandleSet;
+		std::vector<SplitMove> splitMoves;
+
+		// instructions by ID / 2, and where each block starts.
+		std::vector<Instruction*> instrAt;
+		std::set<unsigned> blockStarts;
+	};
+}
@@ -1,762 +1,1501 @@
-#include <string.h>
-#include <assert.h>
-
-#include "Runtime.h"
-
-#if defined(__linux__)
-	#if defined(__x86_64__)
-		#define _WIN64
-	#else 
-		#define _WIN32
-	#endif
-#endif
-
-enum Tag {
-	TagNot = 0,
-	TagFixnum = 1,
-	TagReal = 2,
-	TagSpec = 3,
-
-	TagNil = 7,
-
-	TagShift = 2,
-	TagMask = 3,
-
-	TagSpecalMask = 0xf,
-	TagSpecalShift = 4,
-};
-
-// 8bits
-enum Type {
-	TypeString = 0,
-	TypeArray = TypeString + 1,
-	TypeClosure = TypeString + 2,
-	TypeUserFunc = TypeString + 3,
-	TypeHashNode = TypeString + 4,
-	TypeUserData = TypeString + 5,
-	TypeHashTable = TypeString + 6,
-};
-
-// common property of heap object
-// obType_ is the type of object
-#define HEAP_OBJECT_HEAD   \
-	int8_t obType;         \
-	int8_t resv1;          \
-	int8_t resv2;          \
-	int8_t resv3
-
-typedef struct {
-	HEAP_OBJECT_HEAD;
-} CommonObject;
-
-///
-/// String object
-/// 
-typedef struct
-{
-	HEAP_OBJECT_HEAD;
-	size_t length;
-	char str[];
-} String;
-
-///
-/// script closure object
-///
-typedef struct
-{
-	HEAP_OBJECT_HEAD;
-	void *content;
-	size_t total;
-	size_t hold;
-	Object params[];
-} Closure;
-
-///
-/// user func object
-///
-typedef struct
-{
-	HEAP_OBJECT_HEAD;
-	void *content;
-} UserClosure;
-
-///
-/// array object
-///
-typedef struct
-{
-	HEAP_OBJECT_HEAD;
-	size_t length;
-	Object array[];
-} Array;
-
-///
-/// User Data
-///
-typedef struct
-{
-	HEAP_OBJECT_HEAD;
-	void *user_data;
-} UserData;
-
-Object *GlobalObjectBuffer = NULL;
-
-Object CreateUserClosure(Object self, void * func)
-{
-	UserClosure *this = (UserClosure*)self;
-	this->obType = TypeUserFunc;
-	this->content = func;
-	return self;
-}
-
-void * UserClosureGet(Object self)
-{
-	assert(IsUserClosure(self));
-	return ((UserClosure*)self)->content;
-}
-
-Object CreateUserData(Object self, void *data)
-{
-	UserData *this = (UserData*)self;
-	this->obType = TypeUserFunc;
-	this->user_data = data;
-	return self;
-}
-
-void * UserDataGet(Object self)
-{
-	return ((UserData*)self)->user_data;
-}
-
-size_t SizeOfUserData()
-{
-	return sizeof(UserData);
-}
-
-size_t SizeOfArray(size_t total)
-{
-	return sizeof(Array) + total * sizeof(Array);
-}
-
-size_t SizeOfUserClosure() 
-{
-	return sizeof(UserClosure);
-}
-
-size_t SizeOfClosure(size_t total) 
-{
-	return sizeof(Closure) + total * sizeof(Object);
-}
-
-size_t SizeOfString(size_t length) 
-{
-	return sizeof(String) + (length + 1) * sizeof(char);
-}
-
-int ToFixnum(Object self)
-{
-	if (IsReal(self))
-		return GetFixnum(self);
-	else if (IsString(self))
-		return StringSize(self) == 0;
-	else if (!IsTagging(self))
-		return 1;
-	else if (IsNil(self))
-		return 0;
-	else 
-		return GetFixnum(self);
-}
-
-/**
- * True - translate self to bool and return.
- *
- * Nil - false
- * Real - true
- * Fixnum - 0 = false, otherwise 1
- * Struct - true
- */
-bool ToLogicValue(Object self)
-{
-	if (!IsTagging(self) || IsReal(self))
-		return true;
-	else if (IsNil(self))
-		return false;
-	else
-		return GetFixnum(self);
-}
-
-bool IsCallable(Object self)
-{
-	return IsClosure(self) || IsUserClosure(self);
-}
-
-bool IsArray(Object self)
-{
-	return !IsUndef(self) && (!IsTagging(self)
-		&& ((Array*)self)->obType == TypeArray);
-}
-
-bool IsHash(Object self)
-{
-	return !IsUndef(self) && (!IsTagging(self)
-		&& ((CommonObject*)self)->obType == TypeHashTable);
-}
-
-bool IsHashNodeList(Object self)
-{
-	return !IsUndef(self) && (!IsTagging(self)
-		&& ((CommonObject*)self)->obType == TypeHashNode);
-}
-
-bool IsUserClosure(Object self)
-{
-	return !IsUndef(self) && (!IsTagging(self)
-		&& ((CommonObject*)self)->obType == TypeUserFunc);
-}
-
-bool IsClosure(Object self)
-{
-	return !IsUndef(self) && (!IsTagging(self)
-		&& ((CommonObject*)self)->obType == TypeClosure);
-}
-
-bool IsString(Object self)
-{
-	return !IsUndef(self) && (!IsTagging(self)
-		&& ((CommonObject*)self)->obType == TypeString);
-}
-
-bool IsUserData(Object self)
-{
-	return !IsUndef(self) && (!IsTagging(self)
-		&& ((CommonObject*)self)->obType == TypeUserData);
-}
-
-bool IsUndef(Object self)
-{
-	return self == 0;
-}
-
-bool IsNil(Object self)
-{
-	return self == TagNil;
-}
-
-bool IsReal(Object self)
-{
-	return (self & TagMask) == TagReal;
-}
-
-bool IsSpecal(Object self)
-{
-	return (self & TagMask) == TagSpec;
-}
-
-bool IsFixnum(Object self)
-{
-	return (self & TagMask) == TagFixnum;
-}
-
-bool IsTagging(Object self)
-{
-	return (self & TagMask) != TagNot;
-}
-
-int GetFixnum(Object self)
-{
-	assert(IsFixnum(self));
-	return (int)(self >> TagShift);
-}
-
-float GetReal(Object self)
-{
-	assert(IsReal(self));
-	int val = (int)(self >> TagShift);
-	return *(float*)&val;
-}
-
-Object CreateFixnum(int value)
-{
-	return (value << TagShift) | TagFixnum;
-}
-
-// FIXEME: dangerous
-Object CreateReal(float value)
-{
-	int val = *(int*)&value;
-	return (val << TagShift) | TagReal;
-}
-
-Object CreateNil()
-{
-	return TagNil;
-}
-
-Object CreateUndef()
-{
-	return 0;
-}
-
-Object CreateString(Object self, const char *source, size_t length)
-{
-	String *this = (String *)self;
-	this->obType = TypeString;
-	this->length = length;
-	strncpy(this->str, source, length);
-	this->str[length] = '\0'; // ensure for C call
-	return (Object)this;
-}
-
-const char *StringGet(Object self)
-{
-	assert(IsString(self));
-	return ((String*)self)->str;
-}
-
-size_t StringSize(Object self)
-{
-	assert(IsString(self));
-	return ((String*)self)->length;
-}
-
-Object CreateClosure(Object self, void *content, size_t total)
-{
-	assert(content);
-	Closure *this = (Closure *)self;
-	this->obType = TypeClosure;
-	this->hold = 0;
-	this->total = total;
-	this->content = content;
-	return (Object)this;
-}
-
-void ClosurePushParam(Object self, Object param)
-{
-	assert(IsClosure(self));
-	Closure *this = (Closure *)self;
-	assert(this->hold + 1 <= this->total);
-	this->params[this->hold] = param;
-	++this->hold;
-}
-
-Object *ClosureParams(Object self)
-{
-	assert(IsClosure(self));
-	return ((Closure*)self)->params;
-}
-
-Object ClosureParamAt(Object self, size_t index)
-{
-	assert(IsClosure(self));
-	Closure *this = (Closure *)self;
-	assert(this->total > index);
-	return this->params[index];
-}
-
-size_t ClosureHold(Object self)
-{
-	assert(IsClosure(self));
-	return ((Closure*)self)->hold;
-}
-
-size_t ClosureTotal(Object self)
-{
-	assert(IsClosure(self));
-	return ((Closure*)self)->total;
-}
-
-void *ClosureContent(Object self)
-{
-	assert(IsClosure(self));
-	return ((Closure*)self)->content;
-}
-
-Object CreateArray(Object self, size_t length)
-{
-	Array *this = (Array*)self;
-	this->obType = TypeArray;
-	this->length = length;
-	memset(this->array, CreateUndef(), sizeof(Object) * length);
-	return (Object)this;
-}
-
-void ArraySet(Object self, size_t idx, Object value)
-{
-	assert(IsArray(self));
-	Array *this = (Array*)self;
-	assert(this->length > idx);
-	this->array[idx] = value;
-}
-
-Object ArrayGet(Object self, size_t idx)
-{
-	assert(IsArray(self));
-	Array *this = (Array*)self;
-	assert(this->length > idx);
-	return this->array[idx];
-}
-
-size_t ArraySize(Object self)
-{
-	assert(IsArray(self));
-	return ((Array*)self)->length;
-}
-
-Object *ArrayPointer(Object self)
-{
-	assert(IsArray(self));
-	return ((Array*)self)->array;
-}
-
-typedef struct HashNodeList
-{
-	HEAP_OBJECT_HEAD;
-	size_t capacity;
-	HashNode content[0];
-} HashNodeList;
-
-typedef struct Hash
-{
-	HEAP_OBJECT_HEAD;
-	size_t capacity;
-	size_t size;
-	size_t max_idx;
-	HashNodeList *content;
-} Hash;
-
-#define HASH_MIN_CAPACITY           (16)
-
-#define _HASH_SEED	(size_t)0xdeadbeef
-
-static size_t HashValue(Object key)
-{
-	// hash _Keyval to size_t value one-to-one
-	return ((size_t)key ^ _HASH_SEED);
-	//return key;
-}
-
-static size_t HashSEQ(const char *_First, size_t _Count)
-{	// FNV-1a hash function for bytes in [_First, _First + _Count)
-#if defined(_WIN64)
-	static_assert(sizeof(size_t) == 8, "This code is for 64-bit size_t.");
-	const size_t _FNV_offset_basis = 14695981039346656037ULL;
-	const size_t _FNV_prime = 1099511628211ULL;
-
-#else /* defined(_WIN64) */
-	static_assert(sizeof(size_t) == 4, "This code is for 32-bit size_t.");
-	const size_t _FNV_offset_basis = 2166136261U;
-	const size_t _FNV_prime = 16777619U;
-#endif /* defined(_WIN64) */
-
-	size_t _Val = _FNV_offset_basis;
-	for (size_t _Next = 0; _Next < _Count; ++_Next)
-	{	// fold in another byte
-		_Val ^= (size_t)_First[_Next];
-		_Val *= _FNV_prime;
-	}
-	return (_Val);
-}
-
-static uintptr_t HashKey(Object key)
-{
-	uintptr_t hash_key;
-	if (IsString(key))
-		hash_key = HashSEQ(StringGet(key), StringSize(key));
-	else if (IsFixnum(key))
-		hash_key = GetFixnum(key);
-	else
-		hash_key = HashValue(key);
-	return hash_key;
-}
-
-static uintptr_t HashNextIndex(uintptr_t key, size_t capacity)
-{
-	return ((key * 2166136261u) + 16777619u) % capacity;
-}
-
-static size_t HashExpandSize(size_t original_capacity)
-{
-	// expand 3/2
-	return original_capacity + (original_capacity >> 1);
-}															
-
-static size_t HashShrinkSize(size_t original_capacity)
-{
-	// shrink 2/3
-	return (size_t)((original_capacity << 1) / 3);
-}
-
-static size_t HashNodeListSize(size_t capacity)
-{
-	return capacity * sizeof(HashNode) + sizeof(HashNodeList);
-}
-
-static Object CreateHashNodeList(Object self, size_t capacity)
-{
-	HashNodeList *this = (HashNodeList*)self;
-	this->obType = TypeHashNode;
-	this->capacity = capacity;
-	memset(this->content, CreateUndef(), sizeof(HashNode) * capacity);
-	return self;
-}
-
-size_t SizeOfHashNodeList(size_t capacity)
-{
-	return HashNodeListSize(capacity);
-}
-
-static size_t SizeOfHash()
-{
-	return sizeof(Hash);
-}
-
-static size_t HashTotalSize(size_t capacity)
-{
-	return sizeof(Hash) + HashNodeListSize(capacity);
-}
-
-extern Object Allocate(size_t size);
-
-//
-// allocate enough capacity.
-static Object HashNewNodeList(size_t capacity)
-{
-	Object node_list = Allocate(HashNodeListSize(capacity));
-	CreateHashNodeList(node_list, capacity);
-	return node_list;
-}
-
-static void HashSet(Object self, uintptr_t key, Object value)
-{
-	assert(IsFixnum(value));
-
-	Hash *hash = (Hash*)self;
-	uintptr_t index = key % hash->capacity;
-	uintptr_t slot = hash->capacity;
-
-	if (IsNil(value)) {
-		value = CreateUndef();
-	}
-
-	HashNodeList *list = hash->content;
-	while (list->content[index].key != key
-		&& !IsNil(list->content[index].value)) {
-		if (slot == hash->capacity
-			&& IsUndef(list->content[index].value)) {
-			slot = index;
-			break;
-		}
-		index = HashNextIndex(index, hash->capacity);
-	}
-
-	if (list->content[index].key == key)
-		slot = index;
-	if (slot == hash->capacity)
-		slot = index;
-
-	if (!IsUndef(value) && (IsNil(list->content[slot].value)
-		|| IsUndef(list->content[slot].value))) {
-		assert(hash->size != hash->capacity);
-		if (key == HashKey(CreateFixnum(hash->max_idx)))
-			hash->max_idx++;
-		hash->size++;
-	}
-
-	if (IsUndef(value) && !IsUndef(list->content[slot].value)
-		&& !IsNil(list->content[slot].value)) {
-		assert(hash->size);
-		if (key == HashKey(CreateFixnum(hash->max_idx - 1)))
-			hash->max_idx--;
-		hash->size--;
-	}
-
-	list->content[slot].value = value;
-	list->content[slot].key = key;
-}
-
-static void HashRehash(Object osrc, HashNodeList *content)
-{
-	assert(IsHash(osrc));
-
-	Hash *src = (Hash*)osrc;
-
-	// replace content and capacity
-	size_t old_capacity = src->capacity;
-	HashNodeList *old_list = src->content;
-	src->content = content;
-	src->capacity = content->capacity;
-	src->size = 0;
-	src->max_idx = 0;
-
-	HashNode *ptr, *limit;
-	for (ptr = old_list->content, limit = old_list->content + old_capacity;
-		ptr != limit; ++ptr) {
-		if (!IsUndef(ptr->value) && !IsNil(ptr->value))
-			HashSet(osrc, ptr->key, ptr->value);
-	}
-}
-
-// 
-// just expand content.
-static void HashExpand(Object self)
-{
-	assert(IsHash(self));
-	Hash *hash = (Hash*)self;
-	size_t future_capacity = HashExpandSize(hash->capacity);
-
-	// before gc, save it as global object
-	GlobalObjectBuffer = &self;
-	HashNodeList *cap = (HashNodeList*)HashNewNodeList(future_capacity);
-	GlobalObjectBuffer = NULL;
-
-	HashRehash(self, cap);
-}
-
-// 
-// just shrink content.
-static void HashShrink(Object self)
-{
-	assert(IsHash(self));
-	Hash *hash = (Hash*)self;
-	size_t future_capacity = HashShrinkSize(hash->capacity);
-
-	// before gc, save it as global object
-	GlobalObjectBuffer = &self;
-	HashNodeList *cap = (HashNodeList*)HashNewNodeList(future_capacity);
-	GlobalObjectBuffer = NULL;
-
-	HashRehash(self, cap);
-}
-
-static bool HashNeedExpand(Object self)
-{
-	assert(IsHash(self));
-	size_t capacity = HashCapacity(self);
-	return HashSize(self) > (capacity - (capacity >> 2));
-}
-
-static bool HashNeedShrink(Object self)
-{
-	assert(IsHash(self));
-	size_t capacity = HashCapacity(self);
-	return capacity > HASH_MIN_CAPACITY
-		&& HashSize(self) < (capacity >> 1);
-}
-
-Object CreateHash()
-{
-	// just allocate once.
-	size_t capacity = HASH_MIN_CAPACITY;
-	Hash *hash = (Hash*)Allocate(HashTotalSize(capacity));
-	hash->obType = TypeHashTable;
-	hash->capacity = capacity;
-	hash->size = 0;
-	hash->max_idx = 0;
-	hash->content = (HashNodeList*)((char*)hash + sizeof(Hash));
-	CreateHashNodeList((Object)hash->content, capacity);
-	return (Object)hash;
-}
-
-size_t HashCapacity(Object hash)
-{
-	assert(IsHash(hash));
-	return ((Hash*)hash)->capacity;
-}
-
-size_t HashSize(Object self)
-{
-	assert(IsHash(self));
-	return ((Hash*)self)->size;
-}
-
-HashNode *HashElement(Object self)
-{
-	assert(IsHash(self));
-	return HashNodeListElement(((Hash*)self)->content);
-}
-
-HashNode * HashNodeListElement(Object self)
-{
-	assert(IsHashNodeList(self));
-	return ((HashNodeList*)self)->content;
-}
-
-Object HashFind(Object self, Object key)
-{
-	assert(IsHash(self));
-	Hash *hash = (Hash*)self; 
-	uint32_t hash_key = HashKey(key);
-	uintptr_t index = hash_key % hash->capacity;
-
-	HashNodeList *list = hash->content;
-	while (list->content[index].key != hash_key
-		&& !IsNil(list->content[index].value)) {
-		if (IsUndef(list->content[index].value))
-			break;
-		index = HashNextIndex(index, list->capacity);
-	}
-
-	if (IsNil(list->content[index].value))
-		return CreateUndef();
-	else
-		return list->content[index].value;
-}
-
-size_t NodeListSize(Object self)
-{
-	assert(IsHashNodeList(self));
-	return HashNodeListSize(((HashNodeList*)self)->capacity);
-}
-
-size_t NodeListElementCapacity(Object self)
-{
-	assert(IsHashNodeList(self));
-	return ((HashNodeList*)self)->capacity;
-}
-
-Object * HashNodeListGet(Object self)
-{
-	assert(IsHash(self));
-	Hash *hash = (Hash*)self;
-	return (Object*)(&hash->content);
-}
-
-void HashSetAndUpdate(Object self, Object key, Object value)
-{
-	assert(IsHash(self));
-
-	if (key == CreateFixnum(-1))
-		key = CreateFixnum(((Hash*)self)->max_idx);
-	uint32_t hash_key = HashKey(key);
-	HashSet(self, hash_key, value);
-	if (HashNeedExpand(self)) 
-		HashExpand(self);
-	else if (HashNeedShrink(self)) 
-		HashShrink(self);
-}
-
-size_t SizeOfObject(Object p)
-{
-    if (IsTagging(p) || IsUndef(p))
-        return 0;
-    CommonObject *Object = (CommonObject*)p;
-    switch (Object->obType)
-    {
-    case TypeString:
-        return SizeOfString(((String*)p)->length);
-    case TypeClosure:
-        return SizeOfClosure(((Closure*)p)->total);
-	case TypeArray:
-		return SizeOfArray(((Array*)p)->length);
-	case TypeHashTable:
-		return SizeOfHash();
-	case TypeHashNode:
-		return SizeOfHashNodeList(((HashNodeList*)p)->capacity);
-	case TypeUserFunc:
-		return SizeOfUserClosure();
-	case TypeUserData:
-		return SizeOfUserData();
-    }
-	assert(0);
-    return 0;
-}
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+
+#include "Runtime.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__linux__)
+	#if defined(__x86_64__)
+		#define _WIN64
+	#else 
+		#define _WIN32
+	#endif
+#endif
+
+// 8bits
+enum Type {
+	TypeString = 0,
+	TypeArray = TypeString + 1,
+	TypeClosure = TypeString + 2,
+	TypeUserFunc = TypeString + 3,
+	TypeHashNode = TypeString + 4,
+	TypeUserData = TypeString + 5,
+	TypeHashTable = TypeString + 6,
+	TypeStringBuffer = TypeString + 7,
+	TypeStringSlice = TypeString + 8,
+	TypeReal = TypeString + 9,
+	TypeForwarded = TypeString + 10,
+};
+
+// common property of heap object
+// obType_ is the type of object
+// gcFlags_ is owned by garbage collector
+// hashCode_ is the key hash, zero until first used as a hash key
+#define HEAP_OBJECT_HEAD   \
+	int8_t obType;         \
+	int8_t gcFlags;        \
+	int8_t resv2;          \
+	int8_t resv3;          \
+	uint32_t hashCode
+
+// memory from the collector is not cleared.
+#define INIT_OBJECT_HEAD(this, type)   \
+	do {                               \
+		(this)->obType = (type);       \
+		(this)->gcFlags = 0;           \
+		(this)->hashCode = 0;          \
+	} while (0)
+
+typedef struct {
+	HEAP_OBJECT_HEAD;
+} CommonObject;
+
+///
+/// String object
+/// 
+typedef struct
+{
+	HEAP_OBJECT_HEAD;
+	size_t length;
+	char str[];
+} String;
+
+///
+/// growable buffer behind concatenated strings, bytes below length
+/// are never rewritten, so every slice into it stays immutable.
+///
+typedef struct
+{
+	HEAP_OBJECT_HEAD;
+	size_t capacity;
+	size_t length;
+	char str[];
+} StringBuffer;
+
+///
+/// string sharing the bytes of a string or string buffer
+///
+typedef struct
+{
+	HEAP_OBJECT_HEAD;
+	Object base;
+	size_t offset;
+	size_t length;
+} StringSlice;
+
+///
+/// script closure object
+///
+typedef struct
+{
+	HEAP_OBJECT_HEAD;
+	void *content;
+	size_t total;
+	size_t hold;
+	Object params[];
+} Closure;
+
+///
+/// user func object
+///
+typedef struct
+{
+	HEAP_OBJECT_HEAD;
+	void *content;
+} UserClosure;
+
+///
+/// array object
+///
+typedef struct
+{
+	HEAP_OBJECT_HEAD;
+	size_t length;
+	Object array[];
+} Array;
+
+///
+/// real which doesn't fit a tagged word
+///
+typedef struct
+{
+	HEAP_OBJECT_HEAD;
+	double value;
+} BoxedReal;
+
+///
+/// User Data
+///
+typedef struct
+{
+	HEAP_OBJECT_HEAD;
+	void *user_data;
+} UserData;
+
+Object *GlobalObjectBuffer = NULL;
+size_t GlobalObjectBufferSize = 1;
+
+#define GC_FLAG_REMEMBERED 0x1
+
+extern Object Allocate(size_t size);
+extern void WriteBarrier(Object host, Object value);
+
+bool ObjectRemembered(Object self)
+{
+	return (((CommonObject*)self)->gcFlags & GC_FLAG_REMEMBERED) != 0;
+}
+
+void ObjectSetRemembered(Object self, bool remembered)
+{
+	CommonObject *this = (CommonObject*)self;
+	if (remembered)
+		this->gcFlags |= GC_FLAG_REMEMBERED;
+	else
+		this->gcFlags &= ~GC_FLAG_REMEMBERED;
+}
+
+size_t ObjectType(Object self)
+{
+	return ((CommonObject*)self)->obType;
+}
+
+size_t ObjectTypeCount()
+{
+	return TypeForwarded;
+}
+
+const char *ObjectTypeName(size_t type)
+{
+	static const char *names[] = {
+		"string", "array", "closure", "user_closure", 
+		"hash_node_list", "user_data", "hash_table",
+		"string_buffer", "string_slice", "real",
+	};
+	assert(type < ObjectTypeCount());
+	return names[type];
+}
+
+///
+/// evacuated object, the first word after header holds new address,
+/// every heap object is large enough to hold it.
+///
+typedef struct
+{
+	HEAP_OBJECT_HEAD;
+	Object forward;
+} Forwarded;
+
+bool IsForwarded(Object self)
+{
+	return ((CommonObject*)self)->obType == TypeForwarded;
+}
+
+void ObjectForwardTo(Object self, Object new_addr)
+{
+	Forwarded *this = (Forwarded*)self;
+	this->obType = TypeForwarded;
+	this->forward = new_addr;
+}
+
+Object ObjectForwardee(Object self)
+{
+	assert(IsForwarded(self));
+	return ((Forwarded*)self)->forward;
+}
+
+Object CreateUserClosure(Object self, void * func)
+{
+	UserClosure *this = (UserClosure*)self;
+	INIT_OBJECT_HEAD(this, TypeUserFunc);
+	this->content = func;
+	return self;
+}
+
+void * UserClosureGet(Object self)
+{
+	assert(IsUserClosure(self));
+	return ((UserClosure*)self)->content;
+}
+
+Object CreateUserData(Object self, void *data)
+{
+	UserData *this = (UserData*)self;
+	INIT_OBJECT_HEAD(this, TypeUserFunc);
+	this->user_data = data;
+	return self;
+}
+
+void * UserDataGet(Object self)
+{
+	return ((UserData*)self)->user_data;
+}
+
+size_t SizeOfUserData()
+{
+	return sizeof(UserData);
+}
+
+size_t SizeOfArray(size_t total)
+{
+	return sizeof(Array) + total * sizeof(Object);
+}
+
+size_t SizeOfUserClosure() 
+{
+	return sizeof(UserClosure);
+}
+
+size_t SizeOfClosure(size_t total) 
+{
+	return sizeof(Closure) + total * sizeof(Object);
+}
+
+size_t SizeOfString(size_t length) 
+{
+	return sizeof(String) + (length + 1) * sizeof(char);
+}
+
+static size_t SizeOfStringBuffer(size_t capacity)
+{
+	return sizeof(StringBuffer) + (capacity + 1) * sizeof(char);
+}
+
+static size_t SizeOfStringSlice()
+{
+	return sizeof(StringSlice);
+}
+
+static size_t SizeOfBoxedReal()
+{
+	return sizeof(BoxedReal);
+}
+
+intptr_t ToFixnum(Object self)
+{
+	if (IsReal(self)) {
+		// out of range reals saturate, casting them is undefined.
+		double value = GetReal(self);
+		if (value != value)
+			return 0;
+		if (value < (double)MIN_FIXNUM)
+			return MIN_FIXNUM;
+		if (value >= -(double)MIN_FIXNUM)
+			return MAX_FIXNUM;
+		return (intptr_t)value;
+	}
+	else if (IsString(self))
+		return StringSize(self) == 0;
+	else if (!IsTagging(self))
+		return 1;
+	else if (IsNil(self))
+		return 0;
+	else 
+		return GetFixnum(self);
+}
+
+/**
+ * True - translate self to bool and return.
+ *
+ * Nil - false
+ * Real - true
+ * Fixnum - 0 = false, otherwise 1
+ * Struct - true
+ */
+bool ToLogicValue(Object self)
+{
+	if (!IsTagging(self) || IsReal(self))
+		return true;
+	else if (IsNil(self))
+		return false;
+	else
+		return GetFixnum(self);
+}
+
+bool IsCallable(Object self)
+{
+	return IsClosure(self) || IsUserClosure(self);
+}
+
+bool IsArray(Object self)
+{
+	return !IsUndef(self) && (!IsTagging(self)
+		&& ((Array*)self)->obType == TypeArray);
+}
+
+bool IsHash(Object self)
+{
+	return !IsUndef(self) && (!IsTagging(self)
+		&& ((CommonObject*)self)->obType == TypeHashTable);
+}
+
+bool IsHashNodeList(Object self)
+{
+	return !IsUndef(self) && (!IsTagging(self)
+		&& ((CommonObject*)self)->obType == TypeHashNode);
+}
+
+bool IsUserClosure(Object self)
+{
+	return !IsUndef(self) && (!IsTagging(self)
+		&& ((CommonObject*)self)->obType == TypeUserFunc);
+}
+
+bool IsClosure(Object self)
+{
+	return !IsUndef(self) && (!IsTagging(self)
+		&& ((CommonObject*)self)->obType == TypeClosure);
+}
+
+bool IsString(Object self)
+{
+	return !IsUndef(self) && (!IsTagging(self)
+		&& (((CommonObject*)self)->obType == TypeString
+			|| ((CommonObject*)self)->obType == TypeStringSlice));
+}
+
+bool IsStringSlice(Object self)
+{
+	return !IsUndef(self) && (!IsTagging(self)
+		&& ((CommonObject*)self)->obType == TypeStringSlice);
+}
+
+bool IsUserData(Object self)
+{
+	return !IsUndef(self) && (!IsTagging(self)
+		&& ((CommonObject*)self)->obType == TypeUserData);
+}
+
+bool IsUndef(Object self)
+{
+	return self == 0;
+}
+
+bool IsNil(Object self)
+{
+	return self == TagNil;
+}
+
+bool IsReal(Object self)
+{
+	if ((self & TagMask) == TagReal 
+		|| (self & TagSpecalMask) == TagRealSpec)
+		return true;
+	return !IsUndef(self) && !IsTagging(self)
+		&& ((CommonObject*)self)->obType == TypeReal;
+}
+
+bool IsNumber(Object self)
+{
+	return IsFixnum(self) || IsReal(self);
+}
+
+bool IsSpecal(Object self)
+{
+	return (self & TagMask) == TagSpec;
+}
+
+bool IsFixnum(Object self)
+{
+	return (self & TagMask) == TagFixnum;
+}
+
+bool IsTagging(Object self)
+{
+	return (self & TagMask) != TagNot;
+}
+
+intptr_t GetFixnum(Object self)
+{
+	assert(IsFixnum(self));
+	return (intptr_t)self >> TagShift;
+}
+
+//
+// Reals keep all 52 mantissa bits. A double whose top three exponent
+// bits are 011 or 100, that is 2^-255 <= |value| < 2^256, has its 
+// bits 62 and 61 implied by bit 60, they are dropped to make room for 
+// the tag. Zeros, infinities and NaN are special values, other doubles
+// are boxed on the heap.
+//
+#define REAL_SIGN ((uint64_t)1 << 63)
+#define REAL_LOW_MASK (((uint64_t)1 << 61) - 1)
+
+enum RealSpecal {
+	RealZero = 0,
+	RealNegativeZero = 1,
+	RealInfinity = 2,
+	RealNegativeInfinity = 3,
+	RealNaN = 4,
+};
+
+static Object CreateRealSpecal(enum RealSpecal kind)
+{
+	return ((Object)kind << TagSpecalShift) | TagRealSpec;
+}
+
+double GetReal(Object self)
+{
+	assert(IsReal(self));
+	if ((self & TagMask) == TagReal) {
+		uint64_t bits = (uint64_t)self;
+		uint64_t low = (bits >> TagShift) & REAL_LOW_MASK;
+		uint64_t high = (low >> 60) ? ((uint64_t)1 << 61) : ((uint64_t)1 << 62);
+		bits = (bits & REAL_SIGN) | high | low;
+
+		double value;
+		memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+	if (!IsTagging(self))
+		return ((BoxedReal*)self)->value;
+
+	switch (self >> TagSpecalShift)
+	{
+	case RealZero: return 0.0;
+	case RealNegativeZero: return -0.0;
+	case RealInfinity: return INFINITY;
+	case RealNegativeInfinity: return -INFINITY;
+	default: return NAN;
+	}
+}
+
+Object CreateFixnum(intptr_t value)
+{
+	return ((Object)value << TagShift) | TagFixnum;
+}
+
+Object CreateReal(double value)
+{
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	uint64_t top = (bits >> 60) & 0x7;
+	if (top == 0x3 || top == 0x4) {
+		return (Object)((bits & REAL_SIGN) 
+			| ((bits & REAL_LOW_MASK) << TagShift) | TagReal);
+	}
+
+	bool negative = (bits & REAL_SIGN) != 0;
+	if (isnan(value))
+		return CreateRealSpecal(RealNaN);
+	else if (isinf(value))
+		return CreateRealSpecal(negative ? RealNegativeInfinity : RealInfinity);
+	else if (value == 0.0)
+		return CreateRealSpecal(negative ? RealNegativeZero : RealZero);
+
+	BoxedReal *this = (BoxedReal*)Allocate(SizeOfBoxedReal());
+	INIT_OBJECT_HEAD(this, TypeReal);
+	this->value = value;
+	return (Object)this;
+}
+
+double ToReal(Object self)
+{
+	if (IsFixnum(self))
+		return (double)GetFixnum(self);
+	else if (IsReal(self))
+		return GetReal(self);
+	else
+		return (double)ToFixnum(self);
+}
+
+Object CreateNil()
+{
+	return TagNil;
+}
+
+Object CreateUndef()
+{
+	return 0;
+}
+
+Object CreateString(Object self, const char *source, size_t length)
+{
+	String *this = (String *)self;
+	INIT_OBJECT_HEAD(this, TypeString);
+	this->length = length;
+	if (source != NULL)
+		strncpy(this->str, source, length);
+	this->str[length] = '\0'; // ensure for C call
+	return (Object)this;
+}
+
+static const char *StringBaseGet(Object base)
+{
+	if (((CommonObject*)base)->obType == TypeStringBuffer)
+		return ((StringBuffer*)base)->str;
+	return ((String*)base)->str;
+}
+
+const char *StringGet(Object self)
+{
+	assert(IsString(self));
+	if (IsStringSlice(self)) {
+		StringSlice *slice = (StringSlice*)self;
+		return StringBaseGet(slice->base) + slice->offset;
+	}
+	return ((String*)self)->str;
+}
+
+size_t StringSize(Object self)
+{
+	assert(IsString(self));
+	if (IsStringSlice(self))
+		return ((StringSlice*)self)->length;
+	return ((String*)self)->length;
+}
+
+Object *StringSliceBaseGet(Object self)
+{
+	assert(IsStringSlice(self));
+	return &((StringSlice*)self)->base;
+}
+
+// results this short are copied instead of sharing the bytes.
+#define STRING_SLICE_MIN 32
+
+static Object CreateStringSlice(Object base, size_t offset, size_t length)
+{
+	// before gc, save it as global object
+	GlobalObjectBuffer = &base;
+	StringSlice *this = (StringSlice*)Allocate(SizeOfStringSlice());
+	GlobalObjectBuffer = NULL;
+
+	INIT_OBJECT_HEAD(this, TypeStringSlice);
+	this->base = base;
+	this->offset = offset;
+	this->length = length;
+	WriteBarrier((Object)this, base);
+	return (Object)this;
+}
+
+//
+// the slice ends at the used end of its buffer and the rest fits,
+// so appending to it doesn't disturb any other slice.
+static bool StringAppendable(Object self, size_t length)
+{
+	if (!IsStringSlice(self))
+		return false;
+	StringSlice *slice = (StringSlice*)self;
+	if (((CommonObject*)slice->base)->obType != TypeStringBuffer)
+		return false;
+	StringBuffer *buffer = (StringBuffer*)slice->base;
+	return slice->offset + slice->length == buffer->length
+		&& buffer->capacity - buffer->length >= length;
+}
+
+//
+// lhs + rhs, a chain of appends to the latest result only copies 
+// each byte once on average as buffers double when full.
+Object StringConcat(Object lhs, Object rhs)
+{
+	assert(IsString(lhs) && IsString(rhs));
+	size_t left = StringSize(lhs), right = StringSize(rhs);
+	size_t length = left + right;
+
+	if (StringAppendable(lhs, right)) {
+		StringSlice *slice = (StringSlice*)lhs;
+		StringBuffer *buffer = (StringBuffer*)slice->base;
+		memcpy(buffer->str + buffer->length, StringGet(rhs), right);
+		buffer->length += right;
+		buffer->str[buffer->length] = '\0';
+		return CreateStringSlice(slice->base, slice->offset, length);
+	}
+
+	// before gc, save them as global objects
+	Object roots[2] = { lhs, rhs };
+	GlobalObjectBuffer = roots;
+	GlobalObjectBufferSize = 2;
+	Object result;
+	char *str;
+	if (length < STRING_SLICE_MIN) {
+		String *string = (String*)Allocate(SizeOfString(length));
+		INIT_OBJECT_HEAD(string, TypeString);
+		string->length = length;
+		str = string->str;
+		result = (Object)string;
+	}
+	else {
+		size_t capacity = length << 1;
+		StringBuffer *buffer = (StringBuffer*)Allocate(
+			SizeOfStringBuffer(capacity));
+		INIT_OBJECT_HEAD(buffer, TypeStringBuffer);
+		buffer->capacity = capacity;
+		buffer->length = length;
+		str = buffer->str;
+		result = (Object)buffer;
+	}
+	GlobalObjectBuffer = NULL;
+	GlobalObjectBufferSize = 1;
+
+	memcpy(str, StringGet(roots[0]), left);
+	memcpy(str + left, StringGet(roots[1]), right);
+	str[length] = '\0';
+	if (length < STRING_SLICE_MIN)
+		return result;
+	return CreateStringSlice(result, 0, length);
+}
+
+Object StringSubstr(Object self, size_t offset, size_t length)
+{
+	assert(IsString(self));
+	assert(offset + length <= StringSize(self));
+	if (length < STRING_SLICE_MIN) {
+		// before gc, save it as global object
+		GlobalObjectBuffer = &self;
+		String *this = (String*)Allocate(SizeOfString(length));
+		GlobalObjectBuffer = NULL;
+
+		INIT_OBJECT_HEAD(this, TypeString);
+		this->length = length;
+		memcpy(this->str, StringGet(self) + offset, length);
+		this->str[length] = '\0';
+		return (Object)this;
+	}
+	if (!IsStringSlice(self))
+		return CreateStringSlice(self, offset, length);
+	StringSlice *slice = (StringSlice*)self;
+	return CreateStringSlice(slice->base, slice->offset + offset, length);
+}
+
+Object CreateClosure(Object self, void *content, size_t total)
+{
+	assert(content);
+	Closure *this = (Closure *)self;
+	INIT_OBJECT_HEAD(this, TypeClosure);
+	this->hold = 0;
+	this->total = total;
+	this->content = content;
+	return (Object)this;
+}
+
+void ClosurePushParam(Object self, Object param)
+{
+	assert(IsClosure(self));
+	Closure *this = (Closure *)self;
+	assert(this->hold + 1 <= this->total);
+	this->params[this->hold] = param;
+	++this->hold;
+	WriteBarrier(self, param);
+}
+
+Object *ClosureParams(Object self)
+{
+	assert(IsClosure(self));
+	return ((Closure*)self)->params;
+}
+
+Object ClosureParamAt(Object self, size_t index)
+{
+	assert(IsClosure(self));
+	Closure *this = (Closure *)self;
+	assert(this->total > index);
+	return this->params[index];
+}
+
+size_t ClosureHold(Object self)
+{
+	assert(IsClosure(self));
+	return ((Closure*)self)->hold;
+}
+
+size_t ClosureTotal(Object self)
+{
+	assert(IsClosure(self));
+	return ((Closure*)self)->total;
+}
+
+void *ClosureContent(Object self)
+{
+	assert(IsClosure(self));
+	return ((Closure*)self)->content;
+}
+
+Object CreateArray(Object self, size_t length)
+{
+	Array *this = (Array*)self;
+	INIT_OBJECT_HEAD(this, TypeArray);
+	this->length = length;
+	memset(this->array, CreateUndef(), sizeof(Object) * length);
+	return (Object)this;
+}
+
+void ArraySet(Object self, size_t idx, Object value)
+{
+	assert(IsArray(self));
+	Array *this = (Array*)self;
+	assert(this->length > idx);
+	this->array[idx] = value;
+	WriteBarrier(self, value);
+}
+
+Object ArrayGet(Object self, size_t idx)
+{
+	assert(IsArray(self));
+	Array *this = (Array*)self;
+	assert(this->length > idx);
+	return this->array[idx];
+}
+
+size_t ArraySize(Object self)
+{
+	assert(IsArray(self));
+	return ((Array*)self)->length;
+}
+
+Object *ArrayPointer(Object self)
+{
+	assert(IsArray(self));
+	return ((Array*)self)->array;
+}
+
+//
+// Hash tables are open addressing in the Swiss table style. Slots 
+// come in groups of HASH_GROUP_WIDTH, each slot has a control byte 
+// holding either EMPTY, DELETED, or the low 7 bits of the key's hash,
+// so a whole group is matched with one compare. The node list keeps 
+// the slots first and the control bytes right after them.
+//
+// Fixnum keys 0..n-1 live in an array part instead, which grows by 
+// doubling whenever key n is set and takes over the keys it now 
+// covers from the hash part.
+//
+typedef struct HashNodeList
+{
+	HEAP_OBJECT_HEAD;
+	size_t capacity;
+	HashNode content[0];
+} HashNodeList;
+
+typedef struct Hash
+{
+	HEAP_OBJECT_HEAD;
+	size_t capacity;
+	size_t size;
+	// empty slots which may still be taken before a rehash.
+	size_t growth_left;
+	size_t max_idx;
+	HashNodeList *content;
+	// an Array, or undef before the first index key.
+	Object array;
+	size_t array_count;
+} Hash;
+
+#define HASH_GROUP_WIDTH            (16)
+#define HASH_MIN_CAPACITY           (16)
+#define HASH_MIN_ARRAY              (4)
+
+#define HASH_CTRL_EMPTY             ((int8_t)-128)
+#define HASH_CTRL_DELETED           ((int8_t)-2)
+
+#define _HASH_SEED	(size_t)0xdeadbeef
+
+static uint32_t NextIdentityHash = 0;
+
+static size_t HashMix(uint64_t value)
+{
+	value ^= _HASH_SEED;
+	value *= 0x9e3779b97f4a7c15ULL;
+	return (size_t)(value ^ (value >> 32));
+}
+
+static size_t HashSEQ(const char *_First, size_t _Count)
+{	// FNV-1a hash function for bytes in [_First, _First + _Count)
+#if defined(_WIN64)
+	static_assert(sizeof(size_t) == 8, "This code is for 64-bit size_t.");
+	const size_t _FNV_offset_basis = 14695981039346656037ULL;
+	const size_t _FNV_prime = 1099511628211ULL;
+
+#else /* defined(_WIN64) */
+	static_assert(sizeof(size_t) == 4, "This code is for 32-bit size_t.");
+	const size_t _FNV_offset_basis = 2166136261U;
+	const size_t _FNV_prime = 16777619U;
+#endif /* defined(_WIN64) */
+
+	size_t _Val = _FNV_offset_basis;
+	for (size_t _Next = 0; _Next < _Count; ++_Next)
+	{	// fold in another byte
+		_Val ^= (size_t)_First[_Next];
+		_Val *= _FNV_prime;
+	}
+	return (_Val);
+}
+
+//
+// strings and boxed reals hash by content, cached in the header, 
+// other heap objects get an identity hash the first time they are 
+// used as a key, so neither changes when the collector moves the 
+// object.
+static size_t HashKey(Object key)
+{
+	if (IsTagging(key) || IsUndef(key))
+		return HashMix(key);
+
+	CommonObject *object = (CommonObject*)key;
+	if (object->hashCode == 0) {
+		if (IsString(key)) {
+			size_t hash = HashSEQ(StringGet(key), StringSize(key));
+			object->hashCode = (uint32_t)(hash ^ (hash >> 32));
+		}
+		else if (IsReal(key)) {
+			double value = GetReal(key);
+			size_t hash = HashSEQ((const char*)&value, sizeof(value));
+			object->hashCode = (uint32_t)(hash ^ (hash >> 32));
+		}
+		else {
+			object->hashCode = ++NextIdentityHash;
+		}
+		if (object->hashCode == 0)
+			object->hashCode = 1;
+	}
+	return HashMix(object->hashCode);
+}
+
+static bool HashKeyEqual(Object lhs, Object rhs)
+{
+	if (lhs == rhs)
+		return true;
+	if (IsReal(lhs) && IsReal(rhs) && !IsTagging(lhs) && !IsTagging(rhs)) {
+		double left = GetReal(lhs), right = GetReal(rhs);
+		return memcmp(&left, &right, sizeof(left)) == 0;
+	}
+	return IsString(lhs) && IsString(rhs)
+		&& StringSize(lhs) == StringSize(rhs)
+		&& memcmp(StringGet(lhs), StringGet(rhs), StringSize(lhs)) == 0;
+}
+
+//
+// reals holding an integer are the same key as that fixnum, other
+// reals are compared by their tagged bits, or value once boxed.
+static Object HashNormalizeKey(Object key)
+{
+	if (IsReal(key)) {
+		double value = GetReal(key);
+		intptr_t integer = (intptr_t)value;
+		if ((double)integer == value && FixnumFits(integer))
+			return CreateFixnum(integer);
+	}
+	return key;
+}
+
+static int8_t HashH2(size_t hash)
+{
+	return (int8_t)(hash & 0x7f);
+}
+
+static size_t HashH1(size_t hash)
+{
+	return hash >> 7;
+}
+
+static int8_t *HashControl(HashNodeList *list)
+{
+	return (int8_t*)(list->content + list->capacity);
+}
+
+//
+// bit i of the masks is set when control byte i of the group matches.
+#if defined(__SSE2__)
+static unsigned HashMatchByte(const int8_t *group, int8_t byte)
+{
+	__m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+	return (unsigned)_mm_movemask_epi8(
+		_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(byte)));
+}
+
+static unsigned HashMatchEmpty(const int8_t *group)
+{
+	return HashMatchByte(group, HASH_CTRL_EMPTY);
+}
+
+// both EMPTY and DELETED have the sign bit set.
+static unsigned HashMatchFree(const int8_t *group)
+{
+	__m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+	return (unsigned)_mm_movemask_epi8(ctrl);
+}
+#else
+static unsigned HashMatchByte(const int8_t *group, int8_t byte)
+{
+	unsigned mask = 0;
+	for (unsigned idx = 0; idx < HASH_GROUP_WIDTH; ++idx)
+		if (group[idx] == byte)
+			mask |= 1u << idx;
+	return mask;
+}
+
+static unsigned HashMatchEmpty(const int8_t *group)
+{
+	return HashMatchByte(group, HASH_CTRL_EMPTY);
+}
+
+static unsigned HashMatchFree(const int8_t *group)
+{
+	unsigned mask = 0;
+	for (unsigned idx = 0; idx < HASH_GROUP_WIDTH; ++idx)
+		if (group[idx] < 0)
+			mask |= 1u << idx;
+	return mask;
+}
+#endif // __SSE2__
+
+static unsigned HashLowestBit(unsigned mask)
+{
+	assert(mask != 0);
+#if defined(__GNUC__)
+	return (unsigned)__builtin_ctz(mask);
+#else
+	unsigned idx = 0;
+	while (!(mask & 1)) {
+		mask >>= 1;
+		++idx;
+	}
+	return idx;
+#endif // __GNUC__
+}
+
+// 7/8 of the slots may be filled.
+static size_t HashMaxLoad(size_t capacity)
+{
+	return capacity - (capacity >> 3);
+}
+
+static size_t HashNodeListSize(size_t capacity)
+{
+	return sizeof(HashNodeList) + capacity * sizeof(HashNode) + capacity;
+}
+
+static Object CreateHashNodeList(Object self, size_t capacity)
+{
+	assert(capacity % HASH_GROUP_WIDTH == 0);
+	assert((capacity & (capacity - 1)) == 0);
+
+	HashNodeList *this = (HashNodeList*)self;
+	INIT_OBJECT_HEAD(this, TypeHashNode);
+	this->capacity = capacity;
+	memset(this->content, CreateUndef(), sizeof(HashNode) * capacity);
+	memset(HashControl(this), HASH_CTRL_EMPTY, capacity);
+	return self;
+}
+
+size_t SizeOfHashNodeList(size_t capacity)
+{
+	return HashNodeListSize(capacity);
+}
+
+static size_t SizeOfHash()
+{
+	return sizeof(Hash);
+}
+
+static size_t HashTotalSize(size_t capacity)
+{
+	return sizeof(Hash) + HashNodeListSize(capacity);
+}
+
+//
+// allocate enough capacity.
+static Object HashNewNodeList(size_t capacity)
+{
+	Object node_list = Allocate(HashNodeListSize(capacity));
+	CreateHashNodeList(node_list, capacity);
+	return node_list;
+}
+
+//
+// groups are probed triangularly, which visits every group once 
+// when the number of groups is a power of two.
+static size_t HashLookup(HashNodeList *list, Object key, size_t hash)
+{
+	size_t mask = (list->capacity / HASH_GROUP_WIDTH) - 1;
+	size_t group = HashH1(hash) & mask;
+	int8_t h2 = HashH2(hash);
+	int8_t *ctrl = HashControl(list);
+	for (size_t step = 1; ; ++step) {
+		size_t base = group * HASH_GROUP_WIDTH;
+		unsigned match = HashMatchByte(ctrl + base, h2);
+		while (match) {
+			size_t slot = base + HashLowestBit(match);
+			if (HashKeyEqual(list->content[slot].key, key))
+				return slot;
+			match &= match - 1;
+		}
+		if (HashMatchEmpty(ctrl + base))
+			return list->capacity;
+		group = (group + step) & mask;
+		assert(step <= mask + 1);
+	}
+}
+
+// first EMPTY or DELETED slot on the probe sequence of hash.
+static size_t HashFindFree(HashNodeList *list, size_t hash)
+{
+	size_t mask = (list->capacity / HASH_GROUP_WIDTH) - 1;
+	size_t group = HashH1(hash) & mask;
+	int8_t *ctrl = HashControl(list);
+	for (size_t step = 1; ; ++step) {
+		size_t base = group * HASH_GROUP_WIDTH;
+		unsigned available = HashMatchFree(ctrl + base);
+		if (available)
+			return base + HashLowestBit(available);
+		group = (group + step) & mask;
+		assert(step <= mask + 1);
+	}
+}
+
+static void HashInsertNew(Hash *hash, Object key, size_t code, Object value)
+{
+	HashNodeList *list = hash->content;
+	size_t slot = HashFindFree(list, code);
+	int8_t *ctrl = HashControl(list);
+	if (ctrl[slot] == HASH_CTRL_EMPTY) {
+		assert(hash->growth_left > 0);
+		hash->growth_left--;
+	}
+	ctrl[slot] = HashH2(code);
+	list->content[slot].key = key;
+	list->content[slot].value = value;
+	WriteBarrier((Object)list, key);
+	WriteBarrier((Object)list, value);
+	hash->size++;
+}
+
+// 
+// a slot whose group still has an EMPTY byte can become EMPTY again,
+// no probe sequence runs through a group like that.
+static void HashErase(Hash *hash, size_t slot)
+{
+	HashNodeList *list = hash->content;
+	int8_t *ctrl = HashControl(list);
+	size_t base = slot & ~(size_t)(HASH_GROUP_WIDTH - 1);
+	if (HashMatchEmpty(ctrl + base)) {
+		ctrl[slot] = HASH_CTRL_EMPTY;
+		hash->growth_left++;
+	}
+	else {
+		ctrl[slot] = HASH_CTRL_DELETED;
+	}
+	list->content[slot].key = CreateUndef();
+	list->content[slot].value = CreateUndef();
+	hash->size--;
+}
+
+static bool HashIsIndexKey(Hash *hash, Object key, intptr_t offset)
+{
+	return IsFixnum(key) && GetFixnum(key) == (intptr_t)hash->max_idx + offset;
+}
+
+static size_t HashArraySize(Hash *hash)
+{
+	return IsUndef(hash->array) ? 0 : ArraySize(hash->array);
+}
+
+// index of key in the array part, or the array part's size.
+static size_t HashArrayIndex(Hash *hash, Object key)
+{
+	size_t size = HashArraySize(hash);
+	if (!IsFixnum(key))
+		return size;
+	intptr_t idx = GetFixnum(key);
+	return (idx >= 0 && (size_t)idx < size) ? (size_t)idx : size;
+}
+
+// the append index skips keys already set in the array part.
+static void HashAdvanceIndex(Hash *hash)
+{
+	size_t size = HashArraySize(hash);
+	while (hash->max_idx < size 
+		&& !IsUndef(ArrayGet(hash->array, hash->max_idx)))
+		hash->max_idx++;
+}
+
+static void HashTrackIndex(Hash *hash, Object key, bool removed)
+{
+	if (removed && HashIsIndexKey(hash, key, -1))
+		hash->max_idx--;
+	else if (!removed && HashIsIndexKey(hash, key, 0)) {
+		hash->max_idx++;
+		HashAdvanceIndex(hash);
+	}
+}
+
+static void HashArraySet(Hash *hash, size_t idx, Object value)
+{
+	Object old = ArrayGet(hash->array, idx);
+	if (IsUndef(old) && !IsUndef(value)) {
+		hash->array_count++;
+		HashTrackIndex(hash, CreateFixnum(idx), false);
+	}
+	else if (!IsUndef(old) && IsUndef(value)) {
+		hash->array_count--;
+		HashTrackIndex(hash, CreateFixnum(idx), true);
+	}
+	ArraySet(hash->array, idx, value);
+}
+
+//
+// nil removes the key.
+static void HashSet(Object self, Object key, Object value)
+{
+	Hash *hash = (Hash*)self;
+	if (IsNil(value))
+		value = CreateUndef();
+
+	size_t idx = HashArrayIndex(hash, key);
+	if (idx != HashArraySize(hash)) {
+		HashArraySet(hash, idx, value);
+		return;
+	}
+
+	size_t code = HashKey(key);
+	size_t slot = HashLookup(hash->content, key, code);
+	if (slot != hash->capacity) {
+		if (IsUndef(value)) {
+			HashTrackIndex(hash, key, true);
+			HashErase(hash, slot);
+		}
+		else {
+			hash->content->content[slot].value = value;
+			WriteBarrier((Object)hash->content, value);
+		}
+		return;
+	}
+
+	if (IsUndef(value))
+		return;
+	HashTrackIndex(hash, key, false);
+	HashInsertNew(hash, key, code, value);
+}
+
+static void HashRehash(Object osrc, HashNodeList *content)
+{
+	assert(IsHash(osrc));
+
+	Hash *src = (Hash*)osrc;
+
+	// replace content and capacity
+	HashNodeList *old_list = src->content;
+	src->content = content;
+	src->capacity = content->capacity;
+	WriteBarrier(osrc, (Object)content);
+	src->size = 0;
+	src->growth_left = HashMaxLoad(content->capacity);
+
+	int8_t *ctrl = HashControl(old_list);
+	for (size_t idx = 0; idx < old_list->capacity; ++idx) {
+		if (ctrl[idx] >= 0) {
+			HashNode *node = &old_list->content[idx];
+			HashInsertNew(src, node->key, HashKey(node->key), node->value);
+		}
+	}
+}
+
+//
+// double the array part and move the keys it now covers out of the
+// hash part.
+static Object HashGrowArray(Object self)
+{
+	Hash *hash = (Hash*)self;
+	size_t old_size = HashArraySize(hash);
+	size_t new_size = old_size ? old_size << 1 : HASH_MIN_ARRAY;
+
+	// before gc, save it as global object
+	GlobalObjectBuffer = &self;
+	Object array = Allocate(SizeOfArray(new_size));
+	GlobalObjectBuffer = NULL;
+	CreateArray(array, new_size);
+
+	hash = (Hash*)self;
+	for (size_t idx = 0; idx < old_size; ++idx)
+		ArraySet(array, idx, ArrayGet(hash->array, idx));
+	hash->array = array;
+	WriteBarrier(self, array);
+
+	HashNodeList *list = hash->content;
+	for (size_t idx = old_size; idx < new_size && hash->size; ++idx) {
+		Object key = CreateFixnum(idx);
+		size_t slot = HashLookup(list, key, HashKey(key));
+		if (slot == hash->capacity)
+			continue;
+		ArraySet(array, idx, list->content[slot].value);
+		hash->array_count++;
+		HashErase(hash, slot);
+	}
+	HashAdvanceIndex(hash);
+	return self;
+}
+
+//
+// rebuild with room for size entries, a rehash at the same capacity
+// only drops DELETED slots.
+static void HashResize(Object self, size_t capacity)
+{
+	assert(IsHash(self));
+
+	// before gc, save it as global object
+	GlobalObjectBuffer = &self;
+	HashNodeList *cap = (HashNodeList*)HashNewNodeList(capacity);
+	GlobalObjectBuffer = NULL;
+
+	HashRehash(self, cap);
+}
+
+static size_t HashCapacityFor(size_t size)
+{
+	size_t capacity = HASH_MIN_CAPACITY;
+	while (HashMaxLoad(capacity) <= size)
+		capacity <<= 1;
+	return capacity;
+}
+
+// 
+// Out of EMPTY slots the table doubles, or is rebuilt at the same 
+// capacity when tombstones took the room. It only shrinks once below
+// 1/8 full, and then to twice the room it needs, so a table hovering
+// around one size never rehashes back and forth.
+static void HashGrowIfFull(Object self)
+{
+	Hash *hash = (Hash*)self;
+	if (hash->growth_left == 0)
+		HashResize(self, HashCapacityFor(hash->size + 1));
+}
+
+static void HashShrinkIfSparse(Object self)
+{
+	Hash *hash = (Hash*)self;
+	if (hash->capacity > HASH_MIN_CAPACITY
+		&& hash->size < (hash->capacity >> 3))
+		HashResize(self, HashCapacityFor(hash->size << 1));
+}
+
+static size_t HashArrayCapacityFor(size_t size)
+{
+	if (size == 0)
+		return 0;
+	size_t capacity = HASH_MIN_ARRAY;
+	while (capacity < size)
+		capacity <<= 1;
+	return capacity;
+}
+
+//
+// header, node list and array part come from one allocation.
+Object CreateSizedHash(size_t array_size, size_t hash_size)
+{
+	size_t capacity = HashCapacityFor(hash_size);
+	size_t array_capacity = HashArrayCapacityFor(array_size);
+	size_t total = HashTotalSize(capacity);
+	if (array_capacity)
+		total += SizeOfArray(array_capacity);
+
+	Hash *hash = (Hash*)Allocate(total);
+	INIT_OBJECT_HEAD(hash, TypeHashTable);
+	hash->capacity = capacity;
+	hash->size = 0;
+	hash->growth_left = HashMaxLoad(capacity);
+	hash->max_idx = 0;
+	hash->array = CreateUndef();
+	hash->array_count = 0;
+	hash->content = (HashNodeList*)((char*)hash + sizeof(Hash));
+	CreateHashNodeList((Object)hash->content, capacity);
+	if (array_capacity) {
+		hash->array = (Object)hash + HashTotalSize(capacity);
+		CreateArray(hash->array, array_capacity);
+	}
+	return (Object)hash;
+}
+
+Object CreateHash()
+{
+	return CreateSizedHash(0, 0);
+}
+
+//
+// Cursors run over the array part and then the node list slots. A 
+// cursor is a plain slot index, so it stays valid while the collector
+// moves the table, but not across a resize.
+intptr_t HashNextCursor(Object self, intptr_t cursor)
+{
+	assert(IsHash(self));
+	Hash *hash = (Hash*)self;
+	size_t array_size = HashArraySize(hash);
+	size_t idx = cursor < 0 ? 0 : (size_t)cursor + 1;
+	for (; idx < array_size; ++idx) {
+		if (!IsUndef(ArrayGet(hash->array, idx)))
+			return (intptr_t)idx;
+	}
+
+	int8_t *ctrl = HashControl(hash->content);
+	for (idx -= array_size; idx < hash->capacity; ++idx) {
+		if (ctrl[idx] >= 0)
+			return (intptr_t)(idx + array_size);
+	}
+	return -1;
+}
+
+Object HashCursorKey(Object self, intptr_t cursor)
+{
+	assert(IsHash(self));
+	Hash *hash = (Hash*)self;
+	size_t array_size = HashArraySize(hash);
+	if (cursor < 0)
+		return CreateUndef();
+	if ((size_t)cursor < array_size)
+		return CreateFixnum(cursor);
+	if ((size_t)cursor - array_size < hash->capacity)
+		return hash->content->content[cursor - array_size].key;
+	return CreateUndef();
+}
+
+Object HashCursorValue(Object self, intptr_t cursor)
+{
+	assert(IsHash(self));
+	Hash *hash = (Hash*)self;
+	size_t array_size = HashArraySize(hash);
+	if (cursor < 0)
+		return CreateUndef();
+	if ((size_t)cursor < array_size)
+		return ArrayGet(hash->array, cursor);
+	if ((size_t)cursor - array_size < hash->capacity)
+		return hash->content->content[cursor - array_size].value;
+	return CreateUndef();
+}
+
+//
+// rebuild at the smallest capacity holding the entries.
+void HashCompact(Object self)
+{
+	assert(IsHash(self));
+	Hash *hash = (Hash*)self;
+	size_t capacity = HashCapacityFor(hash->size);
+	if (capacity != hash->capacity || hash->growth_left 
+		!= HashMaxLoad(capacity) - hash->size)
+		HashResize(self, capacity);
+}
+
+size_t HashCapacity(Object hash)
+{
+	assert(IsHash(hash));
+	return ((Hash*)hash)->capacity;
+}
+
+size_t HashSize(Object self)
+{
+	assert(IsHash(self));
+	Hash *hash = (Hash*)self;
+	return hash->size + hash->array_count;
+}
+
+HashNode *HashElement(Object self)
+{
+	assert(IsHash(self));
+	return HashNodeListElement((Object)((Hash*)self)->content);
+}
+
+HashNode * HashNodeListElement(Object self)
+{
+	assert(IsHashNodeList(self));
+	return ((HashNodeList*)self)->content;
+}
+
+Object HashFind(Object self, Object key)
+{
+	assert(IsHash(self));
+	Hash *hash = (Hash*)self; 
+	key = HashNormalizeKey(key);
+	size_t idx = HashArrayIndex(hash, key);
+	if (idx != HashArraySize(hash))
+		return ArrayGet(hash->array, idx);
+
+	size_t slot = HashLookup(hash->content, key, HashKey(key));
+	if (slot == hash->capacity)
+		return CreateUndef();
+	return hash->content->content[slot].value;
+}
+
+size_t NodeListSize(Object self)
+{
+	assert(IsHashNodeList(self));
+	return HashNodeListSize(((HashNodeList*)self)->capacity);
+}
+
+size_t NodeListElementCapacity(Object self)
+{
+	assert(IsHashNodeList(self));
+	return ((HashNodeList*)self)->capacity;
+}
+
+Object * HashNodeListGet(Object self)
+{
+	assert(IsHash(self));
+	Hash *hash = (Hash*)self;
+	return (Object*)(&hash->content);
+}
+
+Object * HashArrayPartGet(Object self)
+{
+	assert(IsHash(self));
+	return &((Hash*)self)->array;
+}
+
+void HashSetAndUpdate(Object self, Object key, Object value)
+{
+	assert(IsHash(self));
+
+	Hash *hash = (Hash*)self;
+	if (key == CreateFixnum(-1))
+		key = CreateFixnum(hash->max_idx);
+	key = HashNormalizeKey(key);
+
+	// in range index keys never resize.
+	size_t idx = HashArrayIndex(hash, key);
+	if (idx != HashArraySize(hash)) {
+		HashArraySet(hash, idx, IsNil(value) ? CreateUndef() : value);
+		return;
+	}
+
+	HashSet(self, key, value);
+	if (IsNil(value) || IsUndef(value)) {
+		HashShrinkIfSparse(self);
+		return;
+	}
+	if (IsFixnum(key) && GetFixnum(key) == (intptr_t)idx)
+		self = HashGrowArray(self);
+	HashGrowIfFull(self);
+}
+
+size_t SizeOfObject(Object p)
+{
+    if (IsTagging(p) || IsUndef(p))
+        return 0;
+    CommonObject *Object = (CommonObject*)p;
+    switch (Object->obType)
+    {
+    case TypeString:
+        return SizeOfString(((String*)p)->length);
+	case TypeStringBuffer:
+		return SizeOfStringBuffer(((StringBuffer*)p)->capacity);
+	case TypeStringSlice:
+		return SizeOfStringSlice();
+	case TypeReal:
+		return SizeOfBoxedReal();
+    case TypeClosure:
+        return SizeOfClosure(((Closure*)p)->total);
+	case TypeArray:
+		return SizeOfArray(((Array*)p)->length);
+	case TypeHashTable:
+		return SizeOfHash();
+	case TypeHashNode:
+		return SizeOfHashNodeList(((HashNodeList*)p)->capacity);
+	case TypeUserFunc:
+		return SizeOfUserClosure();
+	case TypeUserData:
+		return SizeOfUserData();
+    }
+	assert(0);
+    return 0;
+}
@@ -1,101 +1,167 @@
-﻿#ifndef __RUNTIME_H__
-#define __RUNTIME_H__
-
-#include <stdint.h>
-#include <stddef.h>
-#include <stdbool.h>
-
-#ifdef __cplusplus
-extern "C" {
-#endif
-
-#define MEM_BIT (8*sizeof(uintptr_t))
-
-#define MAX_FIXNUM ((1 << (MEM_BIT - 2)) - 1)
-#define MIN_FIXNUM ((MAX_FIXNUM << 1) | 1)
-
-typedef uintptr_t Object;
-
-typedef struct HashNode
-{
-	uintptr_t key;
-	Object value;
-} HashNode;
-
-int GetFixnum(Object self);
-float GetReal(Object self);
-
-Object CreateFixnum(int value);
-Object CreateReal(float value);
-Object CreateNil();
-Object CreateUndef();
-
-/* make string from exist str and memory. */
-Object CreateString(Object self, const char *source, size_t length);
-const char *StringGet(Object self);
-size_t StringSize(Object self);
-
-Object CreateClosure(Object self, void *content, size_t total);
-void ClosurePushParam(Object self, Object param);
-Object *ClosureParams(Object self);
-Object ClosureParamAt(Object self, size_t index);
-size_t ClosureHold(Object self);
-size_t ClosureTotal(Object self);
-void *ClosureContent(Object self);
-
-Object CreateArray(Object self, size_t length);
-void ArraySet(Object self, size_t idx, Object value);
-Object ArrayGet(Object self, size_t idx);
-size_t ArraySize(Object self);
-Object *ArrayPointer(Object self);
-
-Object CreateHash();
-size_t HashCapacity(Object hash);
-size_t HashSize(Object self);
-Object HashFind(Object self, Object key);
-size_t NodeListSize(Object self);
-size_t NodeListElementCapacity(Object self);
-Object *HashNodeListGet(Object self);
-HashNode *HashElement(Object self);
-HashNode *HashNodeListElement(Object self);
-void HashSetAndUpdate(Object self, Object key, Object value);
-
-Object CreateUserClosure(Object self, void *func);
-void *UserClosureGet(Object self);
-
-Object CreateUserData(Object self, void *data);
-void *UserDataGet(Object self);
-
-size_t SizeOfUserData();
-size_t SizeOfArray(size_t total);
-size_t SizeOfUserClosure();
-size_t SizeOfClosure(size_t total);
-size_t SizeOfString(size_t length);
-
-int ToFixnum(Object self);
-
-bool ToLogicValue(Object self);
-bool IsCallable(Object self);
-
-bool IsArray(Object self);
-bool IsHash(Object self);
-bool IsHashNodeList(Object self);
-bool IsUserClosure(Object self);
-bool IsClosure(Object self);
-bool IsString(Object self);
-bool IsUserData(Object self);
-
-bool IsUndef(Object self);
-bool IsNil(Object self);
-bool IsReal(Object self);
-bool IsSpecal(Object self);
-bool IsFixnum(Object self);
-bool IsTagging(Object self);
-
-size_t SizeOfObject(Object self);
-
-#ifdef __cplusplus
-}
-#endif 
-
-#endif // !__RUNTIME_H__
+﻿#ifndef __RUNTIME_H__
+#define __RUNTIME_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MEM_BIT (8*sizeof(uintptr_t))
+
+#define MAX_FIXNUM (((intptr_t)1 << (MEM_BIT - 3)) - 1)
+#define MIN_FIXNUM (-MAX_FIXNUM - 1)
+
+typedef uintptr_t Object;
+
+enum Tag {
+	TagNot = 0,
+	TagFixnum = 1,
+	TagReal = 2,
+	TagSpec = 3,
+
+	TagNil = 7,
+	TagRealSpec = 0xb,
+
+	TagShift = 2,
+	TagMask = 3,
+
+	TagSpecalMask = 0xf,
+	TagSpecalShift = 4,
+};
+
+/* inline forms of IsFixnum/GetFixnum/CreateFixnum for hot paths. */
+static inline bool IsFixnumPair(Object lhs, Object rhs)
+{
+	return (((lhs ^ TagFixnum) | (rhs ^ TagFixnum)) & TagMask) == 0;
+}
+
+static inline intptr_t FixnumValue(Object self)
+{
+	return (intptr_t)self >> TagShift;
+}
+
+static inline Object FixnumObject(intptr_t value)
+{
+	return ((Object)value << TagShift) | TagFixnum;
+}
+
+static inline bool FixnumFits(intptr_t value)
+{
+	return MIN_FIXNUM <= value && value <= MAX_FIXNUM;
+}
+
+// unused slots hold undef in both fields.
+typedef struct HashNode
+{
+	Object key;
+	Object value;
+} HashNode;
+
+intptr_t GetFixnum(Object self);
+double GetReal(Object self);
+
+Object CreateFixnum(intptr_t value);
+Object CreateReal(double value);
+Object CreateNil();
+Object CreateUndef();
+
+/* make string from exist str and memory, NULL leaves it to caller. */
+Object CreateString(Object self, const char *source, size_t length);
+/* bytes of a string, only flat strings end with '\0'. */
+const char *StringGet(Object self);
+size_t StringSize(Object self);
+Object *StringSliceBaseGet(Object self);
+/* both allocate, the result may share bytes with self or lhs. */
+Object StringConcat(Object lhs, Object rhs);
+Object StringSubstr(Object self, size_t offset, size_t length);
+
+Object CreateClosure(Object self, void *content, size_t total);
+void ClosurePushParam(Object self, Object param);
+Object *ClosureParams(Object self);
+Object ClosureParamAt(Object self, size_t index);
+size_t ClosureHold(Object self);
+size_t ClosureTotal(Object self);
+void *ClosureContent(Object self);
+
+Object CreateArray(Object self, size_t length);
+void ArraySet(Object self, size_t idx, Object value);
+Object ArrayGet(Object self, size_t idx);
+size_t ArraySize(Object self);
+Object *ArrayPointer(Object self);
+
+Object CreateHash();
+Object CreateSizedHash(size_t array_size, size_t hash_size);
+void HashCompact(Object self);
+intptr_t HashNextCursor(Object self, intptr_t cursor);
+Object HashCursorKey(Object self, intptr_t cursor);
+Object HashCursorValue(Object self, intptr_t cursor);
+size_t HashCapacity(Object hash);
+size_t HashSize(Object self);
+Object HashFind(Object self, Object key);
+size_t NodeListSize(Object self);
+size_t NodeListElementCapacity(Object self);
+Object *HashNodeListGet(Object self);
+Object *HashArrayPartGet(Object self);
+HashNode *HashElement(Object self);
+HashNode *HashNodeListElement(Object self);
+void HashSetAndUpdate(Object self, Object key, Object value);
+
+Object CreateUserClosure(Object self, void *func);
+void *UserClosureGet(Object self);
+
+Object CreateUserData(Object self, void *data);
+void *UserDataGet(Object self);
+
+size_t SizeOfUserData();
+size_t SizeOfArray(size_t total);
+size_t SizeOfUserClosure();
+size_t SizeOfClosure(size_t total);
+size_t SizeOfString(size_t length);
+
+intptr_t ToFixnum(Object self);
+double ToReal(Object self);
+
+bool ToLogicValue(Object self);
+bool IsCallable(Object self);
+
+bool IsArray(Object self);
+bool IsHash(Object self);
+bool IsHashNodeList(Object self);
+bool IsUserClosure(Object self);
+bool IsClosure(Object self);
+bool IsString(Object self);
+bool IsStringSlice(Object self);
+bool IsUserData(Object self);
+
+bool IsUndef(Object self);
+bool IsNil(Object self);
+bool IsReal(Object self);
+bool IsNumber(Object self);
+bool IsSpecal(Object self);
+bool IsFixnum(Object self);
+bool IsTagging(Object self);
+
+size_t SizeOfObject(Object self);
+
+/* type of heap object, in [0, ObjectTypeCount()). */
+size_t ObjectType(Object self);
+size_t ObjectTypeCount();
+const char *ObjectTypeName(size_t type);
+
+/* remembered set membership, used by generational gc. */
+bool ObjectRemembered(Object self);
+void ObjectSetRemembered(Object self, bool remembered);
+
+/* forwarding pointer stored in header of evacuated object. */
+bool IsForwarded(Object self);
+void ObjectForwardTo(Object self, Object new_addr);
+Object ObjectForwardee(Object self);
+
+#ifdef __cplusplus
+}
+#endif 
+
+#endif // !__RUNTIME_H__
@@ -1,51 +1,65 @@
-#include "UnreachableBlockElimination.h"
-
-#include <cassert>
-#include <vector>
-
-#include "CFG.h"
-#include "Instruction.h"
-#include "IRModule.h"
-
-namespace script
-{
-    void UnreachableBlockElimination::runOnFunction(IRFunction *func) 
-    {
-        assert(func);
-        reachable.clear();
-
-        visit(func->getEntryBlock());
-        eraseUnreachableCode(func);
-    }
-
-    // deep first.
-    void UnreachableBlockElimination::visit(BasicBlock *block) 
-    {
-        assert(block);
-
-        // is visited!
-        if (reachable.count(block))
-            return;
-        reachable.insert(block);
-
-        for (auto succ = block->successor_begin(), 
-            end = block->successor_end();
-            succ != end; ++succ) {
-            visit(*succ);
-        }
-    }
-
-    void UnreachableBlockElimination::eraseUnreachableCode(IRFunction *func)
-    {
-        std::vector<BasicBlock*> deadBlocks;
-        for (auto *block : *func) {
-            if (!reachable.count(block)) {
-                deadBlocks.push_back(block);
-            }
-        }
-
-        for (auto *block : deadBlocks) {
-            func->erase(block);
-        }
-    }
+#include "UnreachableBlockElimination.h"
+
+#include <cassert>
+#include <vector>
+
+#include "CFG.h"
+#include "Instruction.h"
+#include "IRModule.h"
+
+namespace script
+{
+    void UnreachableBlockElimination::runOnFunction(IRFunction *func) 
+    {
+        assert(func);
+        reachable.clear();
+
+        visit(func->getEntryBlock());
+        eraseUnreachableCode(func);
+    }
+
+    // deep first.
+    void UnreachableBlockElimination::visit(BasicBlock *block) 
+    {
+        assert(block);
+
+        // is visited!
+        if (reachable.count(block))
+            return;
+        reachable.insert(block);
+
+        for (auto succ = block->successor_begin(), 
+            end = block->successor_end();
+            succ != end; ++succ) {
+            visit(*succ);
+        }
+    }
+
+    void UnreachableBlockElimination::eraseUnreachableCode(IRFunction *func)
+    {
+        std::vector<BasicBlock*> deadBlocks;
+        for (auto *block : *func) {
+            if (!reachable.count(block)) {
+                deadBlocks.push_back(block);
+            }
+        }
+
+        // detach every dead block before deleting any, erasing one
+        // frees it while another may still list it as successor.
+        for (auto *block : deadBlocks) {
+            while (block->successor_begin() != block->successor_end()) {
+                BasicBlock *succ = *block->successor_begin();
+                block->successor_remove(succ);
+                if (!reachable.count(succ))
+                    continue;
+                succ->precursor_remove(block);
+                for (auto P = succ->phi_begin(); P != succ->phi_end(); ++P)
+                    (*P)->removeIncomingBlock(block);
+            }
+        }
+
+        for (auto *block : deadBlocks) {
+            func->erase(block);
+        }
+    }
 }
\ No newline at end of file
@@ -1,24 +1,24 @@
-#pragma once 
-
-#include <set>
-
-#include "Pass.h"
-
-namespace script
-{
-    class BasicBlock;
-
-    class UnreachableBlockElimination : public FunctionPass
-    {
-    public:
-        virtual ~UnreachableBlockElimination() = default;
-
-        void runOnFunction(IRFunction *func);
-
-    private:
-        void visit(BasicBlock *block);
-        void eraseUnreachableCode(IRFunction *func);
-
-        std::set<BasicBlock*> reachable;
-    };
+#pragma once 
+
+#include <set>
+
+#include "Pass.h"
+
+namespace script
+{
+    class BasicBlock;
+
+    class UnreachableBlockElimination : public FunctionPass
+    {
+    public:
+        virtual ~UnreachableBlockElimination() = default;
+
+        void runOnFunction(IRFunction *func);
+
+    private:
+        void visit(BasicBlock *block);
+        void eraseUnreachableCode(IRFunction *func);
+
+        std::set<BasicBlock*> reachable;
+    };
 }
\ No newline at end of file
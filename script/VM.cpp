@@ -1,560 +1,722 @@
-#include "VM.h"
-
-#include <string>
-#include <vector>
-#include <functional>
-#include <cassert>
-#include <string.h>
-#include <iostream>	
-#include <iomanip>
-
-#include "Buildin.h"
-
-using std::vector;
-using std::string;
-
-extern "C" Object *GlobalObjectBuffer;
-
-namespace script
-{
-	static size_t FrameMaxSize = 256;
-	static GarbageCollector *globalGC;
-
-	void SetGlobalGC(GarbageCollector *GC)
-	{
-		assert(GC);
-		globalGC = GC;
-	}
-
-	void ReleaseGlobalGC()
-	{
-		globalGC = nullptr;
-	}
-
-	extern "C" Object Allocate(size_t size)
-	{
-		assert(globalGC && "Please bind gc object");
-		return globalGC->allocate(size);
-	}
-
-	VMState::VMState() { }
-
-	void VMState::bindScene(VMScene * scene)
-	{
-		currentScene = scene;
-		SetGlobalGC(&scene->GC);
-	}
-
-	VMScene * VMState::getScene()
-	{
-		return currentScene;
-	}
-
-	void VMState::execute()
-	{
-		if (!currentScene || !currentScene->frames.size())
-			return;		 
-
-		bool runState = true;
-		while (runState) {
-			if (currentScene->frames.size() == 0)
-				break;
-			topFrame = &currentScene->frames.back();
-			auto &ip = topFrame->ip;
-			switch (topFrame->content->codes[ip++])
-			{
-			case OK_Add:
-			case OK_Sub:
-			case OK_Div:
-			case OK_Mul:
-			case OK_Great:
-			case OK_GreatThan:
-			case OK_Less:
-			case OK_LessThan:
-			case OK_NotEqual:
-			case OK_Equal:
-				executeBinary(ip, topFrame->content->codes[ip - 1]);
-				break;
-			case OK_Not:
-				executeNotOP(ip);
-				break;
-			case OK_Call:
-				executeCall(ip);
-				break;
-			case OK_TailCall:
-				executeTailCall(ip);
-				break;
-			case OK_Goto:
-				executeGoto(ip);
-				break;
-			case OK_If:
-				executeIf(ip);
-				break;
-			case OK_Return:
-				executeReturn(ip);
-				break;
-			case OK_Load:
-				executeLoad(ip);
-				break;
-			case OK_Store:
-				executeStore(ip);
-				break;
-			case OK_Index:
-				executeIndex(ip);
-				break;
-			case OK_SetIndex:
-				executeSetIndex(ip);
-				break;
-			case OK_Move:
-				executeMove(ip);
-				break;
-			case OK_MoveF:
-				executeMoveF(ip);
-				break;
-			case OK_MoveI:
-				executeMoveI(ip);
-				break;
-			case OK_MoveS:
-				executeMoveS(ip);
-				break;
-			case OK_MoveN:
-				executeMoveN(ip);
-				break;
-			case OK_Halt:
-				runState = false;
-				break;
-			case OK_Param:
-				executeParam(ip);
-				break;
-			case OK_NewClosure:
-				executeNewClosure(ip);
-				break;
-			case OK_UserClosure:
-				executeUserClosure(ip);
-				break;
-			case OK_NewHash:
-				executeNewHash(ip);
-				break;
-			default:
-				break;
-			}
-		}
-	}
-
-	void VMState::callUserClosure(Object closure,
-		int32_t paramsNums, unsigned res)
-	{
-		typedef Object(*UserDefClosure)(VMState*, size_t);
-		UserDefClosure call = (UserDefClosure)UserClosureGet(closure);
-		assert(call);
-
-		// save return reg.
-		currentScene->lastValue = res;
-		Object result = call(this, paramsNums);
-		topFrame->setRegVal(res, result);
-		popParamsStack(paramsNums);
-	}
-
-	void VMState::runtimeError(const char * str)
-	{
-		std::cout << "Except: " << str << std::endl;
-		size_t total = currentScene->frames.size() - 1;
-		for (int i = 0; i < 5; ++i) {
-			VMFrame &frame = currentScene->frames[total - i];
-			size_t idx = frame.content->name;
-			const std::string &name = currentScene->module.getString(idx);
-			std::cout << "\t#" << i << "  0x" << std::setfill('0')
-				<< std::setw(8) << frame.ip << ":\t" << name << std::endl;
-			if (total - i == 0)
-				break;
-		}
-		clearSceneStack();
-		throw "";
-	}
-
-	void VMState::popParamsStack(size_t nums)
-	{
-		while (nums--)
-			currentScene->paramsStack.pop_back();
-	}
-
-	void VMState::clearSceneStack()
-	{
-		currentScene->frames.clear();
-	}
-
-	void VMState::call(Object func, int32_t paramsNums, unsigned res)
-	{
-		size_t hold = ClosureHold(func);
-		size_t stackSize = currentScene->paramsStack.size();
-
-		OpcodeFunction *content =
-			static_cast<OpcodeFunction*>(ClosureContent(func));
-		currentScene->pushFrame(res, content);
-
-		VMFrame *newFrame = &currentScene->frames.back();
-		for (size_t i = 0; i < hold; ++i)
-			newFrame->setParamVal(i, ClosureParamAt(func, i));
-		for (size_t i = hold; i < hold + paramsNums; ++i) {
-			size_t from = stackSize - (hold + paramsNums - i);
-			newFrame->setParamVal(i, currentScene->paramsStack[from]);
-		}
-		if (currentScene->frames.size() + 1 >= FrameMaxSize) {
-			runtimeError("stackoverflow");
-			return;
-		}
-		popParamsStack(paramsNums);
-	}
-
-	void VMState::tailCall(Object func, int32_t paramsNums, unsigned res)
-	{
-		size_t hold = ClosureHold(func);
-		size_t stackSize = currentScene->paramsStack.size();
-
-		OpcodeFunction *content =
-			static_cast<OpcodeFunction*>(ClosureContent(func));
-		if (content != topFrame->content) {
-			unsigned resultReg = topFrame->resReg;
-			currentScene->popFrame(0);
-			currentScene->pushFrame(resultReg, content);
-		}
-		VMFrame *newFrame = topFrame;
-		for (size_t i = 0; i < hold; ++i)
-			newFrame->setParamVal(i, ClosureParamAt(func, i));
-		for (size_t i = hold; i < hold + paramsNums; ++i) {
-			size_t from = stackSize - (hold + paramsNums - i);
-			newFrame->setParamVal(i, currentScene->paramsStack[from]);
-		}
-		popParamsStack(paramsNums);
-	}
-
-	// 
-	// create new closure and fill it's params with old and params stack.
-	Object VMState::fillClosureWithParams(Object func, int32_t paramsNums)
-	{
-		size_t total = ClosureTotal(func);
-		size_t hold = ClosureHold(func);
-		size_t stackSize = currentScene->paramsStack.size();
-
-		Object closure = currentScene->GC.allocate(
-			SizeOfClosure(total));
-		CreateClosure(closure, ClosureContent(func), total);
-
-		for (size_t idx = 0; idx < hold; ++idx)
-			ClosurePushParam(closure, ClosureParamAt(func, idx));
-		for (size_t idx = hold; idx < hold + paramsNums; ++idx) {
-			size_t from = stackSize - (hold + paramsNums - idx);
-			ClosurePushParam(closure, currentScene->paramsStack[from]);
-		}
-		popParamsStack(paramsNums);
-		return closure;
-	}
-
-	void VMState::executeBinary(size_t & ip, unsigned op)
-	{
-		auto &opcode = topFrame->content->codes;
-		unsigned result = opcode[ip++];
-		Object left = topFrame->getRegVal(opcode[ip++]);
-		Object right = topFrame->getRegVal(opcode[ip++]);
-
-		Object calRes = 0;
-		switch (op)
-		{
-		case OK_Add: calRes = Add(left, right); break;
-		case OK_Sub: calRes = Sub(left, right); break;
-		case OK_Div: calRes = Div(left, right); break;
-		case OK_Mul: calRes = Mul(left, right); break;
-		case OK_Great: calRes = Great(left, right); break;
-		case OK_GreatThan: calRes = NotLess(left, right); break;
-		case OK_Less: calRes = Less(left, right); break;
-		case OK_LessThan: calRes = NotGreat(left, right); break;
-		case OK_NotEqual: calRes = NotEqual(left, right); break;
-		case OK_Equal: calRes = Equal(left, right); break;
-		}
-		topFrame->setRegVal(result, calRes);
-	}
-
-	void VMState::executeNotOP(size_t & ip)
-	{
-		auto &opcode = topFrame->content->codes;
-		unsigned result = opcode[ip++];
-		Object val = topFrame->getRegVal(opcode[ip++]);
-		Object res = Not(val);
-		topFrame->setRegVal(result, res);
-	}
-
-	void VMState::executeMove(size_t &ip)
-	{
-		auto &opcode = topFrame->content->codes;
-		unsigned result = opcode[ip++];
-		Object value = topFrame->getRegVal(opcode[ip++]);
-		topFrame->setRegVal(result, value);
-	}
-
-	void VMState::executeMoveF(size_t &ip)
-	{
-		auto &opcode = topFrame->content->codes;
-		unsigned result = opcode[ip++];
-		Object value = CreateReal(getFloat(ip));
-		topFrame->setRegVal(result, value);
-	}
-
-	void VMState::executeMoveI(size_t &ip)
-	{
-		auto &opcode = topFrame->content->codes;
-		unsigned result = opcode[ip++];
-		Object value = CreateFixnum(getInteger(ip));
-		topFrame->setRegVal(result, value);
-	}
-
-	void VMState::executeMoveS(size_t &ip)
-	{
-		auto &opcode = topFrame->content->codes;
-		unsigned result = opcode[ip++];
-		int32_t stringIndex = getInteger(ip);
-		const std::string &string = 
-			currentScene->module.getString(stringIndex);
-		Object str = currentScene->GC.allocate(
-			SizeOfString(string.size()));
-		CreateString(str, string.c_str(), string.size());
-		topFrame->setRegVal(result, str);
-	}
-
-	void VMState::executeMoveN(size_t &ip)
-	{
-		auto &opcode = topFrame->content->codes;
-		unsigned result = opcode[ip++];
-		topFrame->setRegVal(result, CreateNil());
-	}
-
-	void VMState::executeCall(size_t & ip)
-	{
-		auto &opcode = topFrame->content->codes;
-		unsigned resultReg = opcode[ip++];
-		Object func = topFrame->getRegVal(opcode[ip++]);
-		int32_t argc = getInteger(ip);
-
-		assert(currentScene->paramsStack.size() >= argc);
-
-		if (!IsCallable(func)) {
-			runtimeError("try to invoke incallable object");
-			return;
-		}
-
-		if (IsUserClosure(func)) {
-			callUserClosure(func, argc, resultReg);
-			return;
-		}
-
-		int32_t total = ClosureTotal(func);
-		int32_t hold = ClosureHold(func);
-		int32_t target = argc + hold;
-
-		if (target > total) {
-			runtimeError("too many params");
-			return;
-		}
-		if (target == total) 
-			call(func, argc, resultReg);
-		else 
-			topFrame->setRegVal(resultReg,
-				fillClosureWithParams(func, argc));
-	}
-
-	void VMState::executeTailCall(size_t & ip)
-	{
-		auto &opcode = topFrame->content->codes;
-		unsigned resultReg = opcode[ip++];
-		Object func = topFrame->getRegVal(opcode[ip++]);
-		int32_t argc = getInteger(ip);
-
-		assert(currentScene->paramsStack.size() >= argc);
-
-		if (!IsCallable(func)) {
-			runtimeError("try to invoke incallable object");
-			return;
-		}
-
-		if (IsUserClosure(func)) {
-			callUserClosure(func, argc, resultReg);
-			return;
-		}
-
-		int32_t total = ClosureTotal(func);
-		int32_t hold = ClosureHold(func);
-		int32_t target = total + hold;
-
-		if (target > total) {
-			runtimeError("too many params");
-			return;
-		}
-		if (target == total)
-			tailCall(func, argc, resultReg);
-		else
-			topFrame->setRegVal(resultReg,
-				fillClosureWithParams(func, argc));
-	}
-
-	void VMState::executeGoto(size_t & ip)
-	{
-		auto &opcode = topFrame->content->codes;
-		unsigned offset = getInteger(ip);
-		ip = offset;
-	}
-
-	void VMState::executeIf(size_t & ip)
-	{
-		auto &opcode = topFrame->content->codes;
-		Object cond = topFrame->getRegVal(opcode[ip++]);
-		unsigned offset = getInteger(ip);
-		if (ToLogicValue(cond))
-			ip = offset;
-	}
-
-	void VMState::executeReturn(size_t & ip)
-	{
-		auto &opcode = topFrame->content->codes;
-		Object val = topFrame->getRegVal(opcode[ip++]);
-		currentScene->popFrame(val);
-	}
-
-	void VMState::executeLoad(size_t & ip)
-	{
-		auto &opcode = topFrame->content->codes;
-		unsigned result = opcode[ip++];
-		int32_t slot = getInteger(ip);
-		Object val = topFrame->getParamVal(slot);
-		topFrame->setRegVal(result, val);
-	}
-
-	void VMState::executeStore(size_t & ip)
-	{
-		auto &opcode = topFrame->content->codes;
-		Object val = topFrame->getRegVal(opcode[ip++]);
-		int32_t slot = getInteger(ip);
-		topFrame->setParamVal(slot, val);
-	}
-
-	void VMState::executeIndex(size_t & ip)
-	{
-		auto &opcode = topFrame->content->codes;
-		unsigned result = opcode[ip++];
-		Object table = topFrame->getRegVal(opcode[ip++]);
-		Object index = topFrame->getRegVal(opcode[ip++]);
-		Object res = HashFind(table, index);
-		topFrame->setRegVal(result, res);
-	}
-
-	void VMState::executeSetIndex(size_t & ip)
-	{
-		auto &opcode = topFrame->content->codes;
-		Object table = topFrame->getRegVal(opcode[ip++]);
-		Object index = topFrame->getRegVal(opcode[ip++]);
-		Object data = topFrame->getRegVal(opcode[ip++]);
-		HashSetAndUpdate(table, index, data);
-	}
-
-	void VMState::executeParam(size_t & ip)
-	{
-		auto &opcode = topFrame->content->codes;
-		Object val = topFrame->getRegVal(opcode[ip++]);
-		currentScene->paramsStack.push_back(val);
-	}
-
-	void VMState::executeNewClosure(size_t & ip)
-	{
-		auto &opcode = topFrame->content->codes;
-		unsigned result = opcode[ip++];
-		int32_t offset = getInteger(ip);
-		int32_t argc = getInteger(ip);
-
-		assert(currentScene->paramsStack.size() >= argc);
-
-		const std::string &name = currentScene->module.getString(offset);
-		auto *content = &currentScene->module.getFunction(name);
-		size_t numOfParams = content->paramSize;
-		Object closure = currentScene->GC.allocate(
-			SizeOfClosure(numOfParams));
-		CreateClosure(closure, content, numOfParams);
-
-		size_t stackSize = currentScene->paramsStack.size();
-		for (size_t idx = 0; idx < argc; ++idx) {
-			size_t from = stackSize - (argc - idx);
-			ClosurePushParam(closure, currentScene->paramsStack[from]);
-		}
-		topFrame->setRegVal(result, closure);
-		popParamsStack(argc);
-	}
-
-	void VMState::executeUserClosure(size_t & ip)
-	{
-		auto &opcode = topFrame->content->codes;
-		unsigned result = opcode[ip++];
-		int32_t offset = getInteger(ip);
-		const std::string &name = currentScene->module.getString(offset);
-		auto *content = currentScene->module.getUserClosure(name);
-		Object closure = currentScene->GC.allocate(SizeOfUserClosure());
-		CreateUserClosure(closure, (void*)(content));
-		topFrame->setRegVal(result, closure);
-	}
-
-	void VMState::executeNewHash(size_t & ip)
-	{
-		auto &opcode = topFrame->content->codes;
-		unsigned result = opcode[ip++];
-		topFrame->setRegVal(result, CreateHash());
-	}
-
-	int32_t VMState::getInteger(size_t & ip)
-	{
-		int32_t result = 0;
-		auto &opcode = topFrame->content->codes;
-		for (int i = 0; i < 4; ++i)
-		{
-			result <<= 8; 
-			result |= (unsigned char)opcode[ip++];
-		}
-		return result;
-	}
-
-	float VMState::getFloat(size_t & ip)
-	{
-		int ival = getInteger(ip), *iptr = &ival;
-		float *fptr = reinterpret_cast<float*>(iptr);
-		return *fptr;
-	}
-
-	void BindGCProcess(VMScene * scene)
-	{
-		auto &GC = scene->GC;
-		GC.bindGlobals(std::bind(&ProcessGlobals, scene));
-		GC.bindReference(std::bind(&ProcessVariableReference,
-			scene, std::placeholders::_1));
-	}
-
-	void VMScene::pushFrame(unsigned RR, const OpcodeFunction * content)
-	{
-		size_t regs = content->numOfregisters,
-			args = content->paramSize;
-
-		Object registers = GC.allocate(SizeOfArray(regs));
-		CreateArray(registers, regs);
-
-		GlobalObjectBuffer = &registers;
-		Object params = GC.allocate(SizeOfArray(args));
-		GlobalObjectBuffer = NULL;
-
-		CreateArray(params, args);
-		frames.push_back({ registers, params, RR, content });
-	}
-
-	void VMScene::popFrame(Object result)
-	{
-		unsigned resReg = frames.back().resReg;
-		frames.pop_back();
-		if (frames.size() > 0)
-			frames.back().setRegVal(resReg, result);
-		else
-			lastValue = result;
-	}
+#include "VM.h"
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <cassert>
+#include <string.h>
+#include <iostream>	
+#include <iomanip>
+
+#include "Buildin.h"
+
+using std::vector;
+using std::string;
+
+extern "C" Object *GlobalObjectBuffer;
+
+// Threaded dispatch needs GCC's labels-as-values, the portable switch
+// loop is used otherwise or when SCRIPT_SWITCH_DISPATCH is defined.
+#if !defined(SCRIPT_THREADED_DISPATCH)
+#if defined(__GNUC__) && !defined(SCRIPT_SWITCH_DISPATCH)
+#define SCRIPT_THREADED_DISPATCH 1
+#else
+#define SCRIPT_THREADED_DISPATCH 0
+#endif
+#endif // !SCRIPT_THREADED_DISPATCH
+
+namespace script
+{
+	// a site which deoptimized this many times stays generic.
+	static const int32_t QuickenLimit = 4;
+
+	static GarbageCollector *globalGC;
+
+	void SetGlobalGC(GarbageCollector *GC)
+	{
+		assert(GC);
+		globalGC = GC;
+	}
+
+	void ReleaseGlobalGC()
+	{
+		globalGC = nullptr;
+	}
+
+	extern "C" Object Allocate(size_t size)
+	{
+		assert(globalGC && "Please bind gc object");
+		return globalGC->allocate(size);
+	}
+
+	extern "C" void WriteBarrier(Object host, Object value)
+	{
+		globalGC->writeBarrier(host, value);
+	}
+
+	VMState::VMState() 
+		: callCacheHits_(0), callCacheMisses_(0)
+	{ 
+	}
+
+	void VMState::bindScene(VMScene * scene)
+	{
+		currentScene = scene;
+		SetGlobalGC(&scene->GC);
+	}
+
+	VMScene * VMState::getScene()
+	{
+		return currentScene;
+	}
+
+	void VMState::execute()
+	{
+		if (!currentScene || !currentScene->frames.size())
+			return;
+
+		// a nested execute (e.g. `require`) only runs the frames it pushed.
+		const size_t entryDepth = currentScene->frames.size();
+
+		// hot state is cached in locals and only reloaded when the
+		// top frame changes, which is also the only time the value
+		// stack can grow.
+		DecodedInstr *code = nullptr;
+		DecodedInstr *pc = nullptr;
+		DecodedInstr *I = nullptr;
+		Object *regs = nullptr;
+
+#define VM_SAVE_IP()	(topFrame->ip = pc - code)
+#define VM_RELOAD()	do {										\
+			if (currentScene->frames.size() < entryDepth)			\
+				return;												\
+			topFrame = &currentScene->frames.back();				\
+			code = topFrame->content->decoded.data();				\
+			pc = code + topFrame->ip;								\
+			regs = currentScene->stack.data()						\
+				+ topFrame->registerBase();							\
+		} while (0)
+
+#if SCRIPT_THREADED_DISPATCH
+		static const void *dispatchTable[] = {
+			&&L_OK_Goto, &&L_OK_Not,
+			&&L_OK_Add, &&L_OK_Sub, &&L_OK_Mul, &&L_OK_Div,
+			&&L_OK_Great, &&L_OK_GreatThan, &&L_OK_Less,
+			&&L_OK_LessThan, &&L_OK_Equal, &&L_OK_NotEqual,
+			&&L_OK_AddImm, &&L_OK_SubImm, &&L_OK_GreatImm,
+			&&L_OK_GreatThanImm, &&L_OK_LessImm, &&L_OK_LessThanImm,
+			&&L_OK_EqualImm, &&L_OK_NotEqualImm,
+			&&L_OK_MoveS, &&L_OK_MoveI, &&L_OK_MoveL, &&L_OK_MoveF, &&L_OK_MoveN,
+			&&L_OK_Move, &&L_OK_Load, &&L_OK_Index, &&L_OK_Store,
+			&&L_OK_SetIndex, &&L_OK_If, 
+			&&L_OK_JumpIfGreat, &&L_OK_JumpIfGreatThan, &&L_OK_JumpIfLess,
+			&&L_OK_JumpIfLessThan, &&L_OK_JumpIfEqual, &&L_OK_JumpIfNotEqual,
+			&&L_OK_JumpUnlessGreat, &&L_OK_JumpUnlessGreatThan,
+			&&L_OK_JumpUnlessLess, &&L_OK_JumpUnlessLessThan,
+			&&L_OK_Param, &&L_OK_Call,
+			&&L_OK_TailCall, &&L_OK_Return, &&L_OK_ReturnN, &&L_OK_NewHash,
+			&&L_OK_NewClosure, &&L_OK_UserClosure, &&L_OK_Halt,
+			&&L_OK_AddII, &&L_OK_SubII, &&L_OK_GreatII,
+			&&L_OK_GreatThanII, &&L_OK_LessII, &&L_OK_LessThanII,
+			&&L_OK_EqualII, &&L_OK_NotEqualII,
+		};
+		static_assert(sizeof(dispatchTable) / sizeof(*dispatchTable)
+			== OK_NotEqualII + 1, "dispatch table out of sync with Opcode");
+
+#define VM_CASE(op)	L_##op:
+#define VM_DISPATCH()	do { I = pc++; goto *dispatchTable[I->op]; } while (0)
+#else
+#define VM_CASE(op)	case op:
+#define VM_DISPATCH()	continue
+#endif // SCRIPT_THREADED_DISPATCH
+
+#define VM_BINARY(op, func)										\
+		VM_CASE(op) {											\
+			regs[I->a] = func(regs[I->b], regs[I->c]);			\
+			VM_DISPATCH();										\
+		}
+
+		// generic op quickens itself once it sees two fixnums.
+#define VM_QUICKEN_BINARY(generic, quick, func)					\
+		VM_CASE(generic) {											\
+			Object lhs = regs[I->b], rhs = regs[I->c];			\
+			if (IsFixnumPair(lhs, rhs) && I->ext < QuickenLimit)	\
+				I->op = quick;									\
+			regs[I->a] = func(lhs, rhs);						\
+			VM_DISPATCH();										\
+		}
+
+		// guard failed, fall back to the generic op for good.
+#define VM_DEOPTIMIZE(generic, func)							\
+		{														\
+			I->op = generic;									\
+			++I->ext;											\
+			regs[I->a] = func(lhs, rhs);						\
+			VM_DISPATCH();										\
+		}
+
+		// the constant has no register to fall back on, so the
+		// Imm forms stay and take the generic path in place.
+#define VM_SLOW_PATH(func)										\
+		{														\
+			regs[I->a] = func(lhs, rhs);						\
+			VM_DISPATCH();										\
+		}
+
+#define VM_ARITH_II(quick, func, oper, RHS, FALLBACK)			\
+		VM_CASE(quick) {										\
+			Object lhs = regs[I->b], rhs = RHS;					\
+			if (IsFixnumPair(lhs, rhs)) {						\
+				intptr_t value = FixnumValue(lhs) oper FixnumValue(rhs);	\
+				regs[I->a] = FixnumFits(value)					\
+					? FixnumObject(value) : func(lhs, rhs);		\
+				VM_DISPATCH();									\
+			}													\
+			FALLBACK											\
+		}
+
+		// tagged fixnums order like their values.
+#define VM_COMPARE_II(quick, func, oper, RHS, FALLBACK)			\
+		VM_CASE(quick) {										\
+			Object lhs = regs[I->b], rhs = RHS;					\
+			if (IsFixnumPair(lhs, rhs)) {						\
+				regs[I->a] = FixnumObject(						\
+					(intptr_t)lhs oper (intptr_t)rhs);			\
+				VM_DISPATCH();									\
+			}													\
+			FALLBACK											\
+		}
+
+		// fused compare and branch, fixnums compare inline.
+#define VM_JUMP_IF(op, func, oper, sense)						\
+		VM_CASE(op) {											\
+			Object lhs = regs[I->a], rhs = regs[I->b];			\
+			bool result = IsFixnumPair(lhs, rhs)				\
+				? ((intptr_t)lhs oper (intptr_t)rhs)			\
+				: ToLogicValue(func(lhs, rhs));					\
+			if (result == sense)								\
+				pc = code + I->imm;								\
+			VM_DISPATCH();										\
+		}
+
+		VM_RELOAD();
+
+#if SCRIPT_THREADED_DISPATCH
+		VM_DISPATCH();
+#else
+		for (;;) {
+		I = pc++;
+		switch (I->op)
+		{
+#endif // SCRIPT_THREADED_DISPATCH
+		VM_QUICKEN_BINARY(OK_Add, OK_AddII, Add)
+		VM_QUICKEN_BINARY(OK_Sub, OK_SubII, Sub)
+		VM_BINARY(OK_Mul, Mul)
+		VM_BINARY(OK_Div, Div)
+		VM_QUICKEN_BINARY(OK_Great, OK_GreatII, Great)
+		VM_QUICKEN_BINARY(OK_GreatThan, OK_GreatThanII, NotLess)
+		VM_QUICKEN_BINARY(OK_Less, OK_LessII, Less)
+		VM_QUICKEN_BINARY(OK_LessThan, OK_LessThanII, NotGreat)
+		VM_QUICKEN_BINARY(OK_Equal, OK_EqualII, Equal)
+		VM_QUICKEN_BINARY(OK_NotEqual, OK_NotEqualII, NotEqual)
+
+		VM_ARITH_II(OK_AddII, Add, +, regs[I->c], VM_DEOPTIMIZE(OK_Add, Add))
+		VM_ARITH_II(OK_SubII, Sub, -, regs[I->c], VM_DEOPTIMIZE(OK_Sub, Sub))
+		VM_COMPARE_II(OK_GreatII, Great, >, regs[I->c], 
+			VM_DEOPTIMIZE(OK_Great, Great))
+		VM_COMPARE_II(OK_GreatThanII, NotLess, >=, regs[I->c], 
+			VM_DEOPTIMIZE(OK_GreatThan, NotLess))
+		VM_COMPARE_II(OK_LessII, Less, <, regs[I->c], 
+			VM_DEOPTIMIZE(OK_Less, Less))
+		VM_COMPARE_II(OK_LessThanII, NotGreat, <=, regs[I->c], 
+			VM_DEOPTIMIZE(OK_LessThan, NotGreat))
+		VM_COMPARE_II(OK_EqualII, Equal, ==, regs[I->c], 
+			VM_DEOPTIMIZE(OK_Equal, Equal))
+		VM_COMPARE_II(OK_NotEqualII, NotEqual, !=, regs[I->c], 
+			VM_DEOPTIMIZE(OK_NotEqual, NotEqual))
+
+		VM_ARITH_II(OK_AddImm, Add, +, FixnumObject(I->imm), VM_SLOW_PATH(Add))
+		VM_ARITH_II(OK_SubImm, Sub, -, FixnumObject(I->imm), VM_SLOW_PATH(Sub))
+		VM_COMPARE_II(OK_GreatImm, Great, >, FixnumObject(I->imm), 
+			VM_SLOW_PATH(Great))
+		VM_COMPARE_II(OK_GreatThanImm, NotLess, >=, FixnumObject(I->imm), 
+			VM_SLOW_PATH(NotLess))
+		VM_COMPARE_II(OK_LessImm, Less, <, FixnumObject(I->imm), 
+			VM_SLOW_PATH(Less))
+		VM_COMPARE_II(OK_LessThanImm, NotGreat, <=, FixnumObject(I->imm), 
+			VM_SLOW_PATH(NotGreat))
+		VM_COMPARE_II(OK_EqualImm, Equal, ==, FixnumObject(I->imm), 
+			VM_SLOW_PATH(Equal))
+		VM_COMPARE_II(OK_NotEqualImm, NotEqual, !=, FixnumObject(I->imm), 
+			VM_SLOW_PATH(NotEqual))
+
+		VM_CASE(OK_Not) {
+			regs[I->a] = Not(regs[I->b]);
+			VM_DISPATCH();
+		}
+		VM_CASE(OK_Move) {
+			regs[I->a] = regs[I->b];
+			VM_DISPATCH();
+		}
+		VM_CASE(OK_MoveI) {
+			regs[I->a] = CreateFixnum(I->imm);
+			VM_DISPATCH();
+		}
+		VM_CASE(OK_MoveL) {
+			int64_t value = static_cast<int64_t>((static_cast<uint64_t>(
+				static_cast<uint32_t>(I->imm)) << 32)
+				| static_cast<uint32_t>(I->ext));
+			if (MIN_FIXNUM <= value && value <= MAX_FIXNUM)
+				regs[I->a] = CreateFixnum(static_cast<intptr_t>(value));
+			else
+				regs[I->a] = CreateReal(static_cast<double>(value));
+			VM_DISPATCH();
+		}
+		VM_CASE(OK_MoveF) {
+			uint64_t bits = (static_cast<uint64_t>(
+				static_cast<uint32_t>(I->imm)) << 32)
+				| static_cast<uint32_t>(I->ext);
+			double fnum;
+			memcpy(&fnum, &bits, sizeof(fnum));
+			regs[I->a] = CreateReal(fnum);
+			VM_DISPATCH();
+		}
+		VM_CASE(OK_MoveN) {
+			regs[I->a] = CreateNil();
+			VM_DISPATCH();
+		}
+		VM_CASE(OK_Goto) {
+			pc = code + I->imm;
+			VM_DISPATCH();
+		}
+		VM_CASE(OK_If) {
+			if (ToLogicValue(regs[I->a]))
+				pc = code + I->imm;
+			VM_DISPATCH();
+		}
+		VM_JUMP_IF(OK_JumpIfGreat, Great, >, true)
+		VM_JUMP_IF(OK_JumpIfGreatThan, NotLess, >=, true)
+		VM_JUMP_IF(OK_JumpIfLess, Less, <, true)
+		VM_JUMP_IF(OK_JumpIfLessThan, NotGreat, <=, true)
+		VM_JUMP_IF(OK_JumpIfEqual, Equal, ==, true)
+		VM_JUMP_IF(OK_JumpIfNotEqual, NotEqual, !=, true)
+		VM_JUMP_IF(OK_JumpUnlessGreat, Great, >, false)
+		VM_JUMP_IF(OK_JumpUnlessGreatThan, NotLess, >=, false)
+		VM_JUMP_IF(OK_JumpUnlessLess, Less, <, false)
+		VM_JUMP_IF(OK_JumpUnlessLessThan, NotGreat, <=, false)
+		VM_CASE(OK_Load) {
+			regs[I->a] = topFrame->getParamVal(I->imm);
+			VM_DISPATCH();
+		}
+		VM_CASE(OK_Store) {
+			topFrame->setParamVal(I->imm, regs[I->a]);
+			VM_DISPATCH();
+		}
+		VM_CASE(OK_Index) {
+			regs[I->a] = HashFind(regs[I->b], regs[I->c]);
+			VM_DISPATCH();
+		}
+		VM_CASE(OK_SetIndex) {
+			HashSetAndUpdate(regs[I->a], regs[I->b], regs[I->c]);
+			VM_DISPATCH();
+		}
+		VM_CASE(OK_Param) {
+			// growing the stack moves the registers.
+			auto &stack = currentScene->stack;
+			if (stack.size() < stack.capacity())
+				stack.push_back(regs[I->a]);
+			else {
+				size_t offset = regs - stack.data();
+				stack.push_back(regs[I->a]);
+				regs = stack.data() + offset;
+			}
+			VM_DISPATCH();
+		}
+		VM_CASE(OK_Return) {
+			Object val = regs[I->a];
+			VM_SAVE_IP();
+			currentScene->popFrame(val);
+			VM_RELOAD();
+			VM_DISPATCH();
+		}
+		VM_CASE(OK_ReturnN) {
+			VM_SAVE_IP();
+			currentScene->popFrame(CreateNil());
+			VM_RELOAD();
+			VM_DISPATCH();
+		}
+		VM_CASE(OK_Call) {
+			VM_SAVE_IP();
+			executeCall(*I);
+			VM_RELOAD();
+			VM_DISPATCH();
+		}
+		VM_CASE(OK_TailCall) {
+			VM_SAVE_IP();
+			executeTailCall(*I);
+			VM_RELOAD();
+			VM_DISPATCH();
+		}
+		VM_CASE(OK_MoveS) {
+			regs[I->a] = currentScene->literals[I->imm];
+			VM_DISPATCH();
+		}
+		VM_CASE(OK_NewClosure) {
+			executeNewClosure(*I);
+			VM_DISPATCH();
+		}
+		VM_CASE(OK_UserClosure) {
+			executeUserClosure(*I);
+			VM_DISPATCH();
+		}
+		VM_CASE(OK_NewHash) {
+			executeNewHash(*I);
+			VM_DISPATCH();
+		}
+		VM_CASE(OK_Halt) {
+			VM_SAVE_IP();
+			return;
+		}
+#if !SCRIPT_THREADED_DISPATCH
+		default:
+			break;
+		}
+		}
+#endif // !SCRIPT_THREADED_DISPATCH
+
+#undef VM_JUMP_IF
+#undef VM_COMPARE_II
+#undef VM_ARITH_II
+#undef VM_SLOW_PATH
+#undef VM_DEOPTIMIZE
+#undef VM_QUICKEN_BINARY
+#undef VM_BINARY
+#undef VM_DISPATCH
+#undef VM_CASE
+#undef VM_RELOAD
+#undef VM_SAVE_IP
+	}
+
+	void VMState::callUserClosure(Object closure,
+		int32_t paramsNums, unsigned res)
+	{
+		typedef Object(*UserDefClosure)(VMState*, const Object*, size_t);
+		UserDefClosure call = (UserDefClosure)UserClosureGet(closure);
+		assert(call);
+
+		// save return reg.
+		currentScene->lastValue = res;
+		Object result = call(this, pendingArgs(paramsNums), paramsNums);
+
+		// the closure may run a nested execute (`require`), which
+		// leaves topFrame pointing at a popped frame.
+		topFrame = &currentScene->frames.back();
+		topFrame->setRegVal(res, result);
+		popArgs(paramsNums);
+	}
+
+	void VMState::runtimeError(const char * str)
+	{
+		std::cout << "Except: " << str << std::endl;
+		size_t total = currentScene->frames.size() - 1;
+		for (int i = 0; i < 5; ++i) {
+			VMFrame &frame = currentScene->frames[total - i];
+			size_t idx = frame.content->name;
+			const std::string &name = currentScene->module.getString(idx);
+			std::cout << "\t#" << i << "  0x" << std::setfill('0')
+				<< std::setw(8) << frame.ip << ":\t" << name << std::endl;
+			if (total - i == 0)
+				break;
+		}
+		clearSceneStack();
+		throw "";
+	}
+
+	Object *VMState::pendingArgs(size_t nums)
+	{
+		auto &stack = currentScene->stack;
+		assert(stack.size() >= topFrame->frameEnd() + nums);
+		return stack.data() + stack.size() - nums;
+	}
+
+	void VMState::popArgs(size_t nums)
+	{
+		auto &stack = currentScene->stack;
+		stack.resize(stack.size() - nums);
+	}
+
+	void VMState::clearSceneStack()
+	{
+		currentScene->frames.clear();
+		currentScene->stack.clear();
+	}
+
+	void VMState::call(Object func, int32_t paramsNums, unsigned res)
+	{
+		const OpcodeFunction *content =
+			static_cast<const OpcodeFunction*>(ClosureContent(func));
+		enterClosure(func, content, ClosureHold(func), paramsNums, res);
+	}
+
+	//
+	// push a frame for content and fill its params with the values
+	// held by func followed by the top paramsNums of params stack.
+	void VMState::enterClosure(Object func, const OpcodeFunction *content,
+		size_t hold, size_t paramsNums, unsigned res)
+	{
+		if (currentScene->frames.full()) {
+			runtimeError("stackoverflow");
+			return;
+		}
+
+		// held params go in front of the pushed arguments.
+		if (hold != 0) {
+			auto &stack = currentScene->stack;
+			size_t args = stack.size() - paramsNums;
+			stack.resize(stack.size() + hold);
+			std::copy_backward(stack.begin() + args,
+				stack.begin() + args + paramsNums, stack.end());
+			std::copy(ClosureParams(func), ClosureParams(func) + hold,
+				stack.begin() + args);
+		}
+		currentScene->pushFrame(res, content, hold + paramsNums);
+	}
+
+	//
+	// the callee replaces the caller in place, so a chain of tail
+	// calls, mutually recursive or not, never deepens the frames.
+	void VMState::tailCall(Object func, int32_t paramsNums)
+	{
+		auto &stack = currentScene->stack;
+		const OpcodeFunction *content =
+			static_cast<const OpcodeFunction*>(ClosureContent(func));
+		size_t hold = ClosureHold(func);
+		size_t args = stack.size() - paramsNums;
+		size_t to = topFrame->base + hold;
+
+		// slide the arguments down over the old params, the two
+		// ranges may overlap either way.
+		if (to + paramsNums > stack.size())
+			stack.resize(to + paramsNums);
+		auto first = stack.begin() + args, last = first + paramsNums;
+		if (to <= args)
+			std::copy(first, last, stack.begin() + to);
+		else
+			std::copy_backward(first, last, stack.begin() + to + paramsNums);
+		std::copy(ClosureParams(func), ClosureParams(func) + hold,
+			stack.begin() + topFrame->base);
+
+		if (content != topFrame->content)
+			currentScene->reuseFrame(content);
+		else
+			stack.resize(topFrame->frameEnd());
+		topFrame->resetIP();
+	}
+
+	// 
+	// create new closure and fill it's params with old and params stack.
+	Object VMState::fillClosureWithParams(Object func, int32_t paramsNums)
+	{
+		size_t total = ClosureTotal(func);
+		size_t hold = ClosureHold(func);
+
+		// func may be moved by gc.
+		GlobalObjectBuffer = &func;
+		Object closure = currentScene->GC.allocate(
+			SizeOfClosure(total));
+		GlobalObjectBuffer = NULL;
+		CreateClosure(closure, ClosureContent(func), total);
+
+		for (size_t idx = 0; idx < hold; ++idx)
+			ClosurePushParam(closure, ClosureParamAt(func, idx));
+		Object *args = pendingArgs(paramsNums);
+		for (int32_t idx = 0; idx < paramsNums; ++idx)
+			ClosurePushParam(closure, args[idx]);
+		popArgs(paramsNums);
+		return closure;
+	}
+
+	void VMState::executeCall(const DecodedInstr &instr)
+	{
+		unsigned resultReg = instr.a;
+		Object func = topFrame->getRegVal(instr.b);
+		int32_t argc = instr.imm;
+
+		assert(currentScene->stack.size() >= topFrame->frameEnd() + argc);
+
+		// monomorphic inline cache, a hit means func is a closure of
+		// the cached function holding exactly cache.hold params.
+		CallCache &cache = topFrame->content->callCaches[instr.ext];
+		if (cache.target && IsClosure(func)
+			&& ClosureContent(func) == cache.target
+			&& ClosureHold(func) == cache.hold) {
+			++callCacheHits_;
+			if (cache.hold + argc == cache.total)
+				enterClosure(func, cache.target, cache.hold, argc, resultReg);
+			else
+				topFrame->setRegVal(resultReg,
+					fillClosureWithParams(func, argc));
+			return;
+		}
+		if (cache.builtin && IsUserClosure(func)
+			&& UserClosureGet(func) == cache.builtin) {
+			++callCacheHits_;
+			callUserClosure(func, argc, resultReg);
+			return;
+		}
+		++callCacheMisses_;
+
+		if (!IsCallable(func)) {
+			runtimeError("try to invoke incallable object");
+			return;
+		}
+
+		if (IsUserClosure(func)) {
+			cache.target = nullptr;
+			cache.builtin = UserClosureGet(func);
+			callUserClosure(func, argc, resultReg);
+			return;
+		}
+
+		int32_t total = ClosureTotal(func);
+		int32_t hold = ClosureHold(func);
+		int32_t target = argc + hold;
+
+		if (target > total) {
+			runtimeError("too many params");
+			return;
+		}
+		cache.target = static_cast<const OpcodeFunction*>(ClosureContent(func));
+		cache.hold = hold;
+		cache.total = total;
+		cache.builtin = nullptr;
+		if (target == total) 
+			call(func, argc, resultReg);
+		else 
+			topFrame->setRegVal(resultReg,
+				fillClosureWithParams(func, argc));
+	}
+
+	void VMState::executeTailCall(const DecodedInstr &instr)
+	{
+		unsigned resultReg = instr.a;
+		Object func = topFrame->getRegVal(instr.b);
+		int32_t argc = instr.imm;
+
+		assert(currentScene->stack.size() >= topFrame->frameEnd() + argc);
+
+		if (!IsCallable(func)) {
+			runtimeError("try to invoke incallable object");
+			return;
+		}
+
+		// no Return follows a tail call, so unless the callee takes
+		// over the frame the result is returned from here.
+		if (IsUserClosure(func)) {
+			callUserClosure(func, argc, resultReg);
+			currentScene->popFrame(topFrame->getRegVal(resultReg));
+			return;
+		}
+
+		int32_t total = ClosureTotal(func);
+		int32_t hold = ClosureHold(func);
+		int32_t target = argc + hold;
+
+		if (target > total) {
+			runtimeError("too many params");
+			return;
+		}
+		if (target == total)
+			tailCall(func, argc);
+		else
+			currentScene->popFrame(fillClosureWithParams(func, argc));
+	}
+
+	void VMState::executeNewClosure(const DecodedInstr &instr)
+	{
+		unsigned result = instr.a;
+		int32_t argc = instr.ext;
+
+		assert(currentScene->stack.size() >= topFrame->frameEnd() + argc);
+
+		auto *content = currentScene->module.functionAt(instr.imm);
+		size_t numOfParams = content->paramSize;
+		Object closure = currentScene->GC.allocate(
+			SizeOfClosure(numOfParams));
+		CreateClosure(closure, content, numOfParams);
+
+		Object *args = pendingArgs(argc);
+		for (int32_t idx = 0; idx < argc; ++idx)
+			ClosurePushParam(closure, args[idx]);
+		topFrame->setRegVal(result, closure);
+		popArgs(argc);
+	}
+
+	void VMState::executeUserClosure(const DecodedInstr &instr)
+	{
+		unsigned result = instr.a;
+		auto *content = currentScene->module.userClosureAt(instr.imm);
+		Object closure = currentScene->GC.allocate(SizeOfUserClosure());
+		CreateUserClosure(closure, (void*)(content));
+		topFrame->setRegVal(result, closure);
+	}
+
+	void VMState::executeNewHash(const DecodedInstr &instr)
+	{
+		topFrame->setRegVal(instr.a, CreateSizedHash(instr.imm, instr.ext));
+	}
+
+	void BindGCProcess(VMScene * scene)
+	{
+		auto &GC = scene->GC;
+		GC.bindGlobals(std::bind(&ProcessGlobals, scene));
+		GC.bindReference(std::bind(&ProcessVariableReference,
+			scene, std::placeholders::_1));
+	}
+
+	void VMScene::pushFrame(unsigned RR, 
+		const OpcodeFunction * content, size_t argc)
+	{
+		assert(stack.size() >= argc);
+		size_t base = stack.size() - argc;
+		VMFrame &frame = frames.push({ &stack, base, RR, content });
+
+		// fresh slots start undefined, like a new array did.
+		stack.resize(frame.frameEnd(), CreateUndef());
+	}
+
+	void VMScene::reuseFrame(const OpcodeFunction * content)
+	{
+		VMFrame &frame = frames.back();
+		frame.content = content;
+
+		// params are already in place, registers left by the caller
+		// are reset so they do not pin garbage.
+		stack.resize(frame.frameEnd(), CreateUndef());
+		std::fill(stack.begin() + frame.registerBase(), stack.end(),
+			CreateUndef());
+	}
+
+	void VMScene::popFrame(Object result)
+	{
+		unsigned resReg = frames.back().resReg;
+		stack.resize(frames.back().base);
+		frames.pop_back();
+		if (!frames.empty())
+			frames.back().setRegVal(resReg, result);
+		else
+			lastValue = result;
+	}
+
+	void VMScene::loadLiterals()
+	{
+		for (size_t idx = literals.size(); 
+			idx < module.literal_size(); ++idx) {
+			const std::string &string = module.getLiteral(idx);
+			Object str = GC.allocatePermanent(SizeOfString(string.size()));
+			CreateString(str, string.c_str(), string.size());
+			literals.push_back(str);
+		}
+	}
 }
\ No newline at end of file
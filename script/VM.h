@@ -1,129 +1,194 @@
-#ifndef __VM_H__
-#define __VM_H__
-
-#include <stdexcept>
-#include <vector>
-#include <string>
-#include <stack>
-#include <queue>
-#include <cassert>
-#include <cstring>
-
-#include "opcode.h"
-#include "Runtime.h"
-#include "GC.h"
-#include "OpcodeModule.h"
-
-namespace script
-{
-	struct VMFrame {
-		VMFrame(Object regs, Object args, unsigned RR,
-			const OpcodeFunction *func)
-			: registers(regs), params(args), ip(0)
-			, content(func), resReg(RR) {
-		}
-
-		~VMFrame() { }
-
-		Object getParamVal(size_t idx) {
-			return ArrayGet(params, idx);
-		}
-
-		void setParamVal(size_t idx, Object val) {
-			ArraySet(params, idx, val);
-		}
-
-		size_t getParamsSize() {
-			return ArraySize(params);
-		}
-
-		Object getRegVal(size_t idx) {
-			return ArrayGet(registers, idx);
-		}
-
-		void setRegVal(size_t idx, Object val) {
-			return ArraySet(registers, idx, val);
-		}
-
-		size_t getRegistersSize() {
-			return ArraySize(registers);
-		}
-
-		void resetIP() { ip = 0; }
-
-		unsigned resReg;
-		size_t ip;
-		Object registers;
-		Object params;
-		const OpcodeFunction *content;
-	};
-
-	struct VMScene {
-		VMScene(OpcodeModule &OM)
-			: module(OM), GC(100 * 1024 * 1024) {}
-
-		void pushFrame(unsigned RR, const OpcodeFunction *func);
-		void popFrame(Object result);
-
-		// return value, when call user closure,
-		// it save the return reg.
-		Object lastValue;
-		OpcodeModule &module;
-		GarbageCollector GC;
-
-		std::vector<Object> paramsStack;
-		std::vector<VMFrame> frames;
-	};
-
-	class VMState
-	{
-	public:
-		VMState();
-
-		void bindScene(VMScene *scene);
-		VMScene *getScene();
-		void execute();
-
-		void call(Object func, int32_t paramsNums, unsigned res);
-		void tailCall(Object func, int32_t paramsNums, unsigned res);
-		void runtimeError(const char *str);
-		Object fillClosureWithParams(Object func, int32_t paramsNum);
-
-	private:
-		void callUserClosure(Object closure, 
-			int32_t paramsNums, unsigned res);
-		void popParamsStack(size_t nums);
-		void clearSceneStack();
-		
-		int32_t getInteger(size_t & ip);
-		float getFloat(size_t & ip);
-
-		void executeBinary(size_t &ip, unsigned op);
-		void executeNotOP(size_t &ip);
-		void executeMove(size_t &ip);
-		void executeMoveI(size_t &ip);
-		void executeMoveF(size_t &ip);
-		void executeMoveS(size_t &ip);
-		void executeMoveN(size_t &ip);
-		void executeCall(size_t &ip);
-		void executeTailCall(size_t &ip);
-		void executeGoto(size_t &ip);
-		void executeIf(size_t &ip);
-		void executeReturn(size_t &ip);
-		void executeLoad(size_t &ip);
-		void executeStore(size_t &ip);
-		void executeIndex(size_t &ip);
-		void executeSetIndex(size_t &ip);
-		void executeParam(size_t &ip);
-		void executeNewClosure(size_t &ip);
-		void executeUserClosure(size_t &ip);
-		void executeNewHash(size_t &ip);
-
-		VMFrame *topFrame;
-		VMScene *currentScene;
-	};
-
-	void BindGCProcess(VMScene *scene);
-}
-
-#endif // !__VM_H__
+#ifndef __VM_H__
+#define __VM_H__
+
+#include <stdexcept>
+#include <vector>
+#include <string>
+#include <stack>
+#include <queue>
+#include <cassert>
+#include <cstring>
+#include <memory>
+
+#include "opcode.h"
+#include "Runtime.h"
+#include "GC.h"
+#include "OpcodeModule.h"
+
+namespace script
+{
+	//
+	// A frame is a window into VMScene::stack, params first and
+	// then registers, so calls do not allocate from the heap.
+	// Arguments are pushed right past the caller's window and
+	// become the callee's params where they lie.
+	struct VMFrame {
+		VMFrame()
+			: resReg(0), ip(0), base(0)
+			, stack(nullptr), content(nullptr) {
+		}
+
+		VMFrame(std::vector<Object> *stack, size_t base,
+			unsigned RR, const OpcodeFunction *func)
+			: resReg(RR), ip(0), base(base)
+			, stack(stack), content(func) {
+		}
+
+		~VMFrame() { }
+
+		Object getParamVal(size_t idx) {
+			assert(idx < getParamsSize());
+			return (*stack)[base + idx];
+		}
+
+		void setParamVal(size_t idx, Object val) {
+			assert(idx < getParamsSize());
+			(*stack)[base + idx] = val;
+		}
+
+		size_t getParamsSize() {
+			return content->paramSize;
+		}
+
+		Object getRegVal(size_t idx) {
+			assert(idx < getRegistersSize());
+			return (*stack)[registerBase() + idx];
+		}
+
+		void setRegVal(size_t idx, Object val) {
+			assert(idx < getRegistersSize());
+			(*stack)[registerBase() + idx] = val;
+		}
+
+		size_t getRegistersSize() {
+			return content->numOfregisters;
+		}
+
+		size_t registerBase() const {
+			return base + content->paramSize;
+		}
+
+		size_t frameEnd() const {
+			return registerBase() + content->numOfregisters;
+		}
+
+		void resetIP() { ip = 0; }
+
+		unsigned resReg;
+		size_t ip;
+		size_t base;
+		std::vector<Object> *stack;
+		const OpcodeFunction *content;
+	};
+
+	//
+	// Frames are taken from an arena sized once per scene, so calls
+	// never move them and a frame pointer stays valid while it lives.
+	class FrameStack {
+	public:
+		explicit FrameStack(size_t maxDepth)
+			: frames_(new VMFrame[maxDepth])
+			, depth_(0), capacity_(maxDepth) {
+		}
+
+		VMFrame &push(const VMFrame &frame) {
+			assert(!full() && "frame stack overflow");
+			return frames_[depth_++] = frame;
+		}
+
+		void pop_back() { assert(depth_ > 0); --depth_; }
+		void clear() { depth_ = 0; }
+
+		VMFrame &back() { assert(depth_ > 0); return frames_[depth_ - 1]; }
+		VMFrame &operator [] (size_t idx) {
+			assert(idx < depth_);
+			return frames_[idx];
+		}
+
+		size_t size() const { return depth_; }
+		size_t capacity() const { return capacity_; }
+		bool empty() const { return depth_ == 0; }
+		bool full() const { return depth_ == capacity_; }
+
+	private:
+		std::unique_ptr<VMFrame[]> frames_;
+		size_t depth_;
+		size_t capacity_;
+	};
+
+	struct VMScene {
+		static const size_t DefaultFrameDepth = 256;
+
+		VMScene(OpcodeModule &OM, const GCOptions &options = GCOptions(),
+			size_t maxDepth = DefaultFrameDepth)
+			: module(OM), GC(options), frames(maxDepth) {}
+
+		// the top argc slots of stack are the new frame's params.
+		void pushFrame(unsigned RR, const OpcodeFunction *func,
+			size_t argc = 0);
+		void popFrame(Object result);
+		// run func in the top frame's storage, for tail calls, its
+		// params must already be in place.
+		void reuseFrame(const OpcodeFunction *func);
+
+		// materialize string constants added by the last link.
+		void loadLiterals();
+
+		// return value, when call user closure,
+		// it save the return reg.
+		Object lastValue;
+		OpcodeModule &module;
+		GarbageCollector GC;
+
+		// immutable strings for OK_MoveS, in permanent space.
+		std::vector<Object> literals;
+
+		// params and registers of all frames followed by the pending
+		// arguments of the next call, scanned as gc roots.
+		std::vector<Object> stack;
+		FrameStack frames;
+	};
+
+	class VMState
+	{
+	public:
+		VMState();
+
+		void bindScene(VMScene *scene);
+		VMScene *getScene();
+		void execute();
+
+		void call(Object func, int32_t paramsNums, unsigned res);
+		void tailCall(Object func, int32_t paramsNums);
+		void runtimeError(const char *str);
+		Object fillClosureWithParams(Object func, int32_t paramsNum);
+
+		size_t callCacheHits() const { return callCacheHits_; }
+		size_t callCacheMisses() const { return callCacheMisses_; }
+
+	private:
+		void enterClosure(Object func, const OpcodeFunction *content,
+			size_t hold, size_t paramsNums, unsigned res);
+		void callUserClosure(Object closure, 
+			int32_t paramsNums, unsigned res);
+		Object *pendingArgs(size_t nums);
+		void popArgs(size_t nums);
+		void clearSceneStack();
+		
+		void executeCall(const DecodedInstr &instr);
+		void executeTailCall(const DecodedInstr &instr);
+		void executeNewClosure(const DecodedInstr &instr);
+		void executeUserClosure(const DecodedInstr &instr);
+		void executeNewHash(const DecodedInstr &instr);
+
+		VMFrame *topFrame;
+		VMScene *currentScene;
+
+		size_t callCacheHits_;
+		size_t callCacheMisses_;
+	};
+
+	void BindGCProcess(VMScene *scene);
+}
+
+#endif // !__VM_H__
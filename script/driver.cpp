@@ -1,72 +1,145 @@
-#include <iostream>
-#include <cstring>
-
-#include "driver.h"
-
-namespace script
-{
-    bool Driver::parseArguments(int argc, char *argv[])
-    {
-        if (argc == 1)
-        {
-            usage();
-            return false;
-        }
-
-        int count = 1;
-        while (count < argc)
-        {
-            if (argv[count][0] == '-')
-            {
-                count = command(count, argv);
-                if (count == -1)
-                    return false;
-                continue;
-            }
-
-            if (filename)
-            {
-                std::cout << "warning: file \"" << argv[count] << "\"be ignore" << std::endl;
-                count++;
-                continue;
-            }
-            filename = argv[count++];
-        }
-
-        if (!filename)
-        {
-            std::cout << "error: no input file" << std::endl;
-            return false;
-        }
-        return true;
-    }
-
-    void Driver::usage()
-    {
-        std::cout << "Usage : [-op] filename" << std::endl;
-        std::cout << "\t -dumpIR" << std::endl;
-        std::cout << "\t -o" << std::endl;
-    }
-
-    int Driver::command(int count, char *argv[])
-    {
-        if (strcmp("-dumpIR", argv[count]) == 0)
-        {
-            dumpIR_ = true;
-        }
-		else if (strcmp("-dumpOpcode", argv[count]) == 0)
-		{
-			dumpOpcode_ = true;
-		}
-        else if (strcmp("-o", argv[count]) == 0)
-        {
-            optimized_ = true;
-        }
-        else
-        {
-            usage();
-            return -1;
-        }
-        return count + 1;
-    }
+#include <iostream>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+
+#include "driver.h"
+
+namespace script
+{
+    // accept sizes like 512K, 64M or 1G, plain number is bytes.
+    static bool parseSize(const char *str, size_t &size)
+    {
+        if (*str < '0' || *str > '9')
+            return false;
+        char *end = nullptr;
+        errno = 0;
+        unsigned long long value = strtoull(str, &end, 10);
+        if (errno == ERANGE)
+            return false;
+        unsigned shift = 0;
+        switch (*end)
+        {
+        case 'g': case 'G': shift += 10;
+            // fall through
+        case 'm': case 'M': shift += 10;
+            // fall through
+        case 'k': case 'K': shift += 10; ++end;
+            break;
+        default: break;
+        }
+        if (*end != '\0' || value == 0 || value > (SIZE_MAX >> shift))
+            return false;
+        size = (size_t)(value << shift);
+        return true;
+    }
+
+    bool Driver::parseArguments(int argc, char *argv[])
+    {
+        if (argc == 1)
+        {
+            usage();
+            return false;
+        }
+
+        int count = 1;
+        while (count < argc)
+        {
+            if (argv[count][0] == '-')
+            {
+                count = command(count, argc, argv);
+                if (count == -1)
+                    return false;
+                continue;
+            }
+
+            if (filename)
+            {
+                std::cout << "warning: file \"" << argv[count] << "\"be ignore" << std::endl;
+                count++;
+                continue;
+            }
+            filename = argv[count++];
+        }
+
+        if (!filename)
+        {
+            std::cout << "error: no input file" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void Driver::usage()
+    {
+        std::cout << "Usage : [-op] filename" << std::endl;
+        std::cout << "\t -dumpIR" << std::endl;
+        std::cout << "\t -o" << std::endl;
+        std::cout << "\t -stats" << std::endl;
+        std::cout << "\t -heap-initial size" << std::endl;
+        std::cout << "\t -heap-max size" << std::endl;
+        std::cout << "\t -heap-growth factor" << std::endl;
+        std::cout << "\t -stack-depth frames" << std::endl;
+    }
+
+    int Driver::command(int count, int argc, char *argv[])
+    {
+        const char *arg = argv[count];
+        if (strncmp("-heap-", arg, 6) == 0)
+        {
+            const char *value = count + 1 < argc ? argv[count + 1] : nullptr;
+            bool ok = value != nullptr;
+            if (ok && strcmp("-heap-initial", arg) == 0)
+                ok = parseSize(value, heapInitial_);
+            else if (ok && strcmp("-heap-max", arg) == 0)
+                ok = parseSize(value, heapMax_);
+            else if (ok && strcmp("-heap-growth", arg) == 0)
+                ok = (heapGrowth_ = atof(value)) > 1.0;
+            else
+                ok = false;
+
+            if (!ok)
+            {
+                usage();
+                return -1;
+            }
+            return count + 2;
+        }
+
+        if (strcmp("-stack-depth", arg) == 0)
+        {
+            int depth = count + 1 < argc ? atoi(argv[count + 1]) : 0;
+            if (depth < 2)
+            {
+                usage();
+                return -1;
+            }
+            stackDepth_ = depth;
+            return count + 2;
+        }
+
+        if (strcmp("-dumpIR", argv[count]) == 0)
+        {
+            dumpIR_ = true;
+        }
+		else if (strcmp("-dumpOpcode", argv[count]) == 0)
+		{
+			dumpOpcode_ = true;
+		}
+        else if (strcmp("-o", argv[count]) == 0)
+        {
+            optimized_ = true;
+        }
+		else if (strcmp("-stats", argv[count]) == 0)
+		{
+			dumpStats_ = true;
+		}
+        else
+        {
+            usage();
+            return -1;
+        }
+        return count + 1;
+    }
 }
\ No newline at end of file
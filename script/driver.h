@@ -1,25 +1,36 @@
-#ifndef __DRIVER_H__
-#define __DRIVER_H__
-
-namespace script
-{
-    class Driver
-    {
-    public:
-        Driver() : filename(nullptr) {}
-        bool parseArguments(int argc, char *argv[]);
-
-    private:
-        void usage();
-        int command(int count, char *argv[]);
-
-    public:
-        bool dumpIR_ = false;
-		bool dumpOpcode_ = false;
-        bool optimized_ = false;
-
-        const char *filename;
-    };
-}
-
-#endif // !__DRIVER_H__
+#ifndef __DRIVER_H__
+#define __DRIVER_H__
+
+#include <cstddef>
+
+namespace script
+{
+    class Driver
+    {
+    public:
+        Driver() : filename(nullptr) {}
+        bool parseArguments(int argc, char *argv[]);
+
+    private:
+        void usage();
+        int command(int count, int argc, char *argv[]);
+
+    public:
+        bool dumpIR_ = false;
+		bool dumpOpcode_ = false;
+        bool optimized_ = false;
+		bool dumpStats_ = false;
+
+		// gc tuning, zero means default.
+		size_t heapInitial_ = 0;
+		size_t heapMax_ = 0;
+		double heapGrowth_ = 0;
+
+		// max call depth, zero means default.
+		size_t stackDepth_ = 0;
+
+        const char *filename;
+    };
+}
+
+#endif // !__DRIVER_H__
@@ -1,331 +1,424 @@
-#include "dumpOpcode.h"
-
-#include <iomanip>
-
-#include "OpcodeModule.h"
-
-using std::endl;
-
-namespace script
-{
-    DumpOpcode::DumpOpcode(OpcodeModule &OM, std::string &file)
-        : file_(file, std::ios::out), module(OM)
-    {
-    }
-
-    void DumpOpcode::dump()
-    {
-		for (auto i : module.functions_) {
-			dumpFunction(i.second);
-		}
-
-        dumpStringPool();
-    }
-
-	void DumpOpcode::dumpInstruction(Opcode & opcode, size_t & ip)
-	{
-	}
-
-	void DumpOpcode::dumpFunction(OpcodeFunction & func)
-	{
-		const auto &opcode = func.codes;
-
-		file_ << "[Function]: " << module.getString(func.name) 
-			<< "\nbegin : " << endl;
-
-		size_t ip = 0;
-		while (true)
-		{
-			if (ip >= opcode.size())
-				break;
-
-			file_ << "  0x" << std::setfill('0') 
-				<< std::setw(8) << ip << ":\t";
-
-			switch (opcode[ip++])
-			{
-			case OK_Add:
-			case OK_Sub:
-			case OK_Div:
-			case OK_Mul:
-			case OK_Great:
-			case OK_GreatThan:
-			case OK_Less:
-			case OK_LessThan:
-			case OK_NotEqual:
-			case OK_Equal:
-				dumpBinary(opcode, ip);
-				break;
-			case OK_Not:
-				dumpNotOP(opcode, ip);
-				break;
-			case OK_Call:
-				dumpCall(opcode, ip);
-				break;
-			case OK_TailCall:
-				dumpTailCall(opcode, ip);
-				break;
-			case OK_Goto:
-				dumpGoto(opcode, ip);
-				break;
-			case OK_If:
-				dumpIf(opcode, ip);
-				break;
-			case OK_Return:
-				dumpReturn(opcode, ip);
-				break;
-			case OK_Load:
-				dumpLoad(opcode, ip);
-				break;
-			case OK_Store:
-				dumpStore(opcode, ip);
-				break;
-			case OK_Move:
-				dumpMove(opcode, ip);
-				break;
-			case OK_MoveF:
-				dumpMoveF(opcode, ip);
-				break;
-			case OK_MoveI:
-				dumpMoveI(opcode, ip);
-				break;
-			case OK_MoveS:
-				dumpMoveS(opcode, ip);
-				break;
-			case OK_MoveN:
-				dumpMoveN(opcode, ip);
-				break;
-			case OK_Halt:
-				dumpHalt(opcode, ip);
-				break;
-			case OK_Param:
-				dumpParam(opcode, ip);
-				break;
-			case OK_NewClosure:
-				dumpNewClosure(opcode, ip);
-				break;
-			case OK_UserClosure:
-				dumpUserClosure(opcode, ip);
-				break;
-			case OK_NewHash:
-				dumpNewHash(opcode, ip);
-				break;
-			case OK_Index:
-				dumpIndex(opcode, ip);
-				break;
-			case OK_SetIndex:
-				dumpSetIndex(opcode, ip);
-				break;
-			}
-		}
-		file_ << "\n\n";
-	}
-
-	void DumpOpcode::dumpBinary(const Opcode &opcode, size_t & ip)
-    {
-        dumpRegister(opcode[ip++]); file_ << " = ";
-        dumpRegister(opcode[ip++]); 
-        switch (opcode[ip - 3])
-        {
-        case OK_Add: file_ << " + "; break;
-        case OK_Sub: file_ << " - "; break;
-        case OK_Div: file_ << " / "; break;
-        case OK_Mul: file_ << " * "; break;
-        case OK_Great: file_ << " > "; break;
-        case OK_GreatThan: file_ << " >= "; break;
-        case OK_Less: file_ << " < "; break;
-        case OK_LessThan: file_ << " <= "; break;
-        case OK_NotEqual: file_ << " != "; break;
-        case OK_Equal: file_ << " == "; break;
-        }
-        dumpRegister(opcode[ip++]);
-        file_ << endl;
-    }
-
-    void DumpOpcode::dumpNotOP(const Opcode &opcode, size_t & ip)
-    {
-        dumpRegister(opcode[ip++]); 
-		file_ << " = !";
-        dumpRegister(opcode[ip++]);
-        file_ << endl;
-    }
-
-    void DumpOpcode::dumpCall(const Opcode &opcode, size_t & ip)
-    {
-        dumpRegister(opcode[ip++]);
-        file_ << " = call "; 
-		dumpRegister(opcode[ip++]);
-        file_ << " <params>:";
-        file_ << getInteger(opcode, ip) << endl;
-    }
-
-    void DumpOpcode::dumpTailCall(const Opcode &opcode, size_t & ip)
-    {
-		dumpRegister(opcode[ip++]);
-		file_ << " = tail_call ";
-		dumpRegister(opcode[ip++]);
-		file_ << " <params>:";
-		file_ << getInteger(opcode, ip) << endl;
-    }
-
-    void DumpOpcode::dumpGoto(const Opcode &opcode, size_t & ip)
-    {
-        file_ << "goto "; 
-        file_ << "@0x" << std::setfill('0')
-			<< std::setw(8) 
-			<< getInteger(opcode, ip) << endl;
-    }
-
-    void DumpOpcode::dumpIf(const Opcode &opcode, size_t & ip)
-    {
-        file_ << "if ";
-        dumpRegister(opcode[ip++]);
-		file_ << " to @0x" << std::setfill('0')
-			<< std::setw(8)
-			<< getInteger(opcode, ip) << endl;
-    }
-
-    void DumpOpcode::dumpReturn(const Opcode &opcode, size_t & ip)
-    {
-        file_ << "return ";
-        dumpRegister(opcode[ip++]);
-        file_ << endl;
-    }
-
-    void DumpOpcode::dumpLoad(const Opcode &opcode, size_t & ip)
-    {
-        file_ << "load ";
-        dumpRegister(opcode[ip++]);
-        file_ << " at " << getInteger(opcode, ip) << endl;
-    }
-
-    void DumpOpcode::dumpStore(const Opcode &opcode, size_t & ip)
-    {
-        file_ << "store ";
-        dumpRegister(opcode[ip++]);
-        file_ << " into " << getInteger(opcode, ip) << endl;
-    }
-
-	void DumpOpcode::dumpIndex(const Opcode & opcode, size_t & ip)
-	{
-		dumpRegister(opcode[ip++]);
-		file_ << " = ";
-		dumpRegister(opcode[ip++]);
-		file_ << "[";
-		dumpRegister(opcode[ip++]);
-		file_ << "]" << endl;
-	}
-
-	void DumpOpcode::dumpSetIndex(const Opcode & opcode, size_t & ip)
-	{
-		dumpRegister(opcode[ip++]);
-		file_ << "[";
-		dumpRegister(opcode[ip++]);
-		file_ << "] = ";
-		dumpRegister(opcode[ip++]);
-		file_ << endl;
-	}
-
-    void DumpOpcode::dumpMove(const Opcode &opcode, size_t & ip)
-    {
-        dumpRegister(opcode[ip++]);
-        file_ << " = ";
-        dumpRegister(opcode[ip++]);
-        file_ << endl;
-    }
-
-    void DumpOpcode::dumpMoveF(const Opcode &opcode, size_t & ip)
-    {
-        dumpRegister(opcode[ip++]);
-        file_ << " = " << getFloat(opcode, ip) << endl;
-    }
-
-    void DumpOpcode::dumpMoveI(const Opcode &opcode, size_t & ip)
-    {
-        dumpRegister(opcode[ip++]);
-        file_ << " = " << getInteger(opcode, ip) << endl;
-    }
-
-    void DumpOpcode::dumpMoveS(const Opcode &opcode, size_t & ip)
-    {
-        dumpRegister(opcode[ip++]);
-        file_ << " = ";
-        file_ << "<string offset>:" << getInteger(opcode, ip);
-        file_ << endl;
-    }
-
-	void DumpOpcode::dumpMoveN(const Opcode & opcode, size_t & ip)
-	{
-		dumpRegister(opcode[ip++]);
-		file_ << " = null";
-		file_ << endl;
-	}
-
-    void DumpOpcode::dumpHalt(const Opcode &opcode, size_t & ip)
-    {
-        file_ << "halt" << endl;
-    }
-
-    void DumpOpcode::dumpParam(const Opcode &opcode, size_t & ip)
-    {
-        file_ << "param ";
-        dumpRegister(opcode[ip++]);
-        file_ << endl;
-    }
-
-    void DumpOpcode::dumpNewClosure(const Opcode &opcode, size_t & ip)
-    {
-		dumpRegister(opcode[ip++]);
-		int32_t offset = getInteger(opcode, ip);
-		const std::string &name = module.getString(offset);
-		file_ << " = new closure : " << name;
-		file_ << " <params>:";
-		file_ << getInteger(opcode, ip) << endl;
-    }
-
-	void DumpOpcode::dumpUserClosure(const Opcode & opcode, size_t & ip)
-	{
-		dumpRegister(opcode[ip++]);
-		int32_t offset = getInteger(opcode, ip);
-		const std::string &name = module.getString(offset);
-		file_ << " = new user closure : " << name << endl;
-	}
-
-    void DumpOpcode::dumpNewHash(const Opcode &opcode, size_t &ip)
-    {
-        dumpRegister(opcode[ip++]);
-        file_ << " = new hash " << endl;
-    }
-    
-    void DumpOpcode::dumpRegister(unsigned reg)
-    {
-		file_ << "$" << reg;
-    }
-
-    void DumpOpcode::dumpStringPool()
-    {
-        file_ << "\n\n[String pool]: \n  size = " 
-			<< module.stringPool_.size() << endl;
-
-		for (size_t i = 0; i < module.stringPool_.size(); ++i) {
-			file_ << "\t" << i << " : " << module.stringPool_[i] << endl;
-		}
-    }
-
-    int32_t DumpOpcode::getInteger(const Opcode &opcode, size_t & ip)
-    {
-        int32_t result = 0;
-        for (int i = 0; i < 4; ++i)
-        {
-            result <<= 8; result |= (unsigned char)opcode[ip++];
-        }
-        return result;
-    }
-
-    float DumpOpcode::getFloat(const Opcode &opcode, size_t & ip)
-    {
-		int val = getInteger(opcode, ip);
-        return *(float*)&val;
-    }
-}
-
+#include "dumpOpcode.h"
+
+#include <cstring>
+#include <iomanip>
+
+#include "OpcodeModule.h"
+
+using std::endl;
+
+namespace script
+{
+    DumpOpcode::DumpOpcode(OpcodeModule &OM, std::string &file)
+        : file_(file, std::ios::out), module(OM)
+    {
+    }
+
+    void DumpOpcode::dump()
+    {
+		for (auto i : module.functions_) {
+			dumpFunction(i.second);
+		}
+
+        dumpStringPool();
+    }
+
+	void DumpOpcode::dumpInstruction(Opcode & opcode, size_t & ip)
+	{
+	}
+
+	void DumpOpcode::dumpFunction(OpcodeFunction & func)
+	{
+		const auto &opcode = func.codes;
+
+		file_ << "[Function]: " << module.getString(func.name) 
+			<< "\nbegin : " << endl;
+
+		size_t ip = 0;
+		while (true)
+		{
+			if (ip >= opcode.size())
+				break;
+
+			file_ << "  0x" << std::setfill('0') 
+				<< std::setw(8) << ip << ":\t";
+
+			switch (opcode[ip++])
+			{
+			case OK_Add:
+			case OK_Sub:
+			case OK_Div:
+			case OK_Mul:
+			case OK_Great:
+			case OK_GreatThan:
+			case OK_Less:
+			case OK_LessThan:
+			case OK_NotEqual:
+			case OK_Equal:
+				dumpBinary(opcode, ip);
+				break;
+			case OK_AddImm:
+			case OK_SubImm:
+			case OK_GreatImm:
+			case OK_GreatThanImm:
+			case OK_LessImm:
+			case OK_LessThanImm:
+			case OK_NotEqualImm:
+			case OK_EqualImm:
+				dumpBinaryImm(opcode, ip);
+				break;
+			case OK_Not:
+				dumpNotOP(opcode, ip);
+				break;
+			case OK_Call:
+				dumpCall(opcode, ip);
+				break;
+			case OK_TailCall:
+				dumpTailCall(opcode, ip);
+				break;
+			case OK_Goto:
+				dumpGoto(opcode, ip);
+				break;
+			case OK_If:
+				dumpIf(opcode, ip);
+				break;
+			case OK_JumpIfGreat:
+			case OK_JumpIfGreatThan:
+			case OK_JumpIfLess:
+			case OK_JumpIfLessThan:
+			case OK_JumpIfEqual:
+			case OK_JumpIfNotEqual:
+			case OK_JumpUnlessGreat:
+			case OK_JumpUnlessGreatThan:
+			case OK_JumpUnlessLess:
+			case OK_JumpUnlessLessThan:
+				dumpJumpIf(opcode, ip);
+				break;
+			case OK_Return:
+				dumpReturn(opcode, ip);
+				break;
+			case OK_ReturnN:
+				dumpReturnN(opcode, ip);
+				break;
+			case OK_Load:
+				dumpLoad(opcode, ip);
+				break;
+			case OK_Store:
+				dumpStore(opcode, ip);
+				break;
+			case OK_Move:
+				dumpMove(opcode, ip);
+				break;
+			case OK_MoveF:
+				dumpMoveF(opcode, ip);
+				break;
+			case OK_MoveI:
+				dumpMoveI(opcode, ip);
+				break;
+			case OK_MoveL:
+				dumpMoveL(opcode, ip);
+				break;
+			case OK_MoveS:
+				dumpMoveS(opcode, ip);
+				break;
+			case OK_MoveN:
+				dumpMoveN(opcode, ip);
+				break;
+			case OK_Halt:
+				dumpHalt(opcode, ip);
+				break;
+			case OK_Param:
+				dumpParam(opcode, ip);
+				break;
+			case OK_NewClosure:
+				dumpNewClosure(opcode, ip);
+				break;
+			case OK_UserClosure:
+				dumpUserClosure(opcode, ip);
+				break;
+			case OK_NewHash:
+				dumpNewHash(opcode, ip);
+				break;
+			case OK_Index:
+				dumpIndex(opcode, ip);
+				break;
+			case OK_SetIndex:
+				dumpSetIndex(opcode, ip);
+				break;
+			}
+		}
+		file_ << "\n\n";
+	}
+
+	void DumpOpcode::dumpBinary(const Opcode &opcode, size_t & ip)
+    {
+        dumpRegister(getRegister(opcode, ip)); file_ << " = ";
+        dumpRegister(getRegister(opcode, ip)); 
+        switch (opcode[ip - 5])
+        {
+        case OK_Add: file_ << " + "; break;
+        case OK_Sub: file_ << " - "; break;
+        case OK_Div: file_ << " / "; break;
+        case OK_Mul: file_ << " * "; break;
+        case OK_Great: file_ << " > "; break;
+        case OK_GreatThan: file_ << " >= "; break;
+        case OK_Less: file_ << " < "; break;
+        case OK_LessThan: file_ << " <= "; break;
+        case OK_NotEqual: file_ << " != "; break;
+        case OK_Equal: file_ << " == "; break;
+        }
+        dumpRegister(getRegister(opcode, ip));
+        file_ << endl;
+    }
+
+	void DumpOpcode::dumpBinaryImm(const Opcode &opcode, size_t & ip)
+    {
+        dumpRegister(getRegister(opcode, ip)); file_ << " = ";
+        dumpRegister(getRegister(opcode, ip)); 
+        switch (opcode[ip - 5])
+        {
+        case OK_AddImm: file_ << " + "; break;
+        case OK_SubImm: file_ << " - "; break;
+        case OK_GreatImm: file_ << " > "; break;
+        case OK_GreatThanImm: file_ << " >= "; break;
+        case OK_LessImm: file_ << " < "; break;
+        case OK_LessThanImm: file_ << " <= "; break;
+        case OK_NotEqualImm: file_ << " != "; break;
+        case OK_EqualImm: file_ << " == "; break;
+        }
+        file_ << getInteger(opcode, ip) << endl;
+    }
+
+    void DumpOpcode::dumpNotOP(const Opcode &opcode, size_t & ip)
+    {
+        dumpRegister(getRegister(opcode, ip)); 
+		file_ << " = !";
+        dumpRegister(getRegister(opcode, ip));
+        file_ << endl;
+    }
+
+    void DumpOpcode::dumpCall(const Opcode &opcode, size_t & ip)
+    {
+        dumpRegister(getRegister(opcode, ip));
+        file_ << " = call "; 
+		dumpRegister(getRegister(opcode, ip));
+        file_ << " <params>:";
+        file_ << getInteger(opcode, ip) << endl;
+    }
+
+    void DumpOpcode::dumpTailCall(const Opcode &opcode, size_t & ip)
+    {
+		dumpRegister(getRegister(opcode, ip));
+		file_ << " = tail_call ";
+		dumpRegister(getRegister(opcode, ip));
+		file_ << " <params>:";
+		file_ << getInteger(opcode, ip) << endl;
+    }
+
+    void DumpOpcode::dumpGoto(const Opcode &opcode, size_t & ip)
+    {
+        file_ << "goto "; 
+        file_ << "@0x" << std::setfill('0')
+			<< std::setw(8) 
+			<< getInteger(opcode, ip) << endl;
+    }
+
+    void DumpOpcode::dumpIf(const Opcode &opcode, size_t & ip)
+    {
+        file_ << "if ";
+        dumpRegister(getRegister(opcode, ip));
+		file_ << " to @0x" << std::setfill('0')
+			<< std::setw(8)
+			<< getInteger(opcode, ip) << endl;
+    }
+
+    void DumpOpcode::dumpJumpIf(const Opcode &opcode, size_t & ip)
+    {
+        Byte op = opcode[ip - 1];
+        bool sense = op < OK_JumpUnlessGreat;
+        file_ << (sense ? "if " : "if !(");
+        dumpRegister(getRegister(opcode, ip));
+        switch (op)
+        {
+        case OK_JumpIfGreat: case OK_JumpUnlessGreat: file_ << " > "; break;
+        case OK_JumpIfGreatThan: case OK_JumpUnlessGreatThan: file_ << " >= "; break;
+        case OK_JumpIfLess: case OK_JumpUnlessLess: file_ << " < "; break;
+        case OK_JumpIfLessThan: case OK_JumpUnlessLessThan: file_ << " <= "; break;
+        case OK_JumpIfEqual: file_ << " == "; break;
+        case OK_JumpIfNotEqual: file_ << " != "; break;
+        }
+        dumpRegister(getRegister(opcode, ip));
+        file_ << (sense ? "" : ")") << " to @0x" << std::setfill('0')
+			<< std::setw(8)
+			<< getInteger(opcode, ip) << endl;
+    }
+
+    void DumpOpcode::dumpReturn(const Opcode &opcode, size_t & ip)
+    {
+        file_ << "return ";
+        dumpRegister(getRegister(opcode, ip));
+        file_ << endl;
+    }
+
+    void DumpOpcode::dumpReturnN(const Opcode &opcode, size_t & ip)
+    {
+        file_ << "return null" << endl;
+    }
+
+    void DumpOpcode::dumpLoad(const Opcode &opcode, size_t & ip)
+    {
+        file_ << "load ";
+        dumpRegister(getRegister(opcode, ip));
+        file_ << " at " << getInteger(opcode, ip) << endl;
+    }
+
+    void DumpOpcode::dumpStore(const Opcode &opcode, size_t & ip)
+    {
+        file_ << "store ";
+        dumpRegister(getRegister(opcode, ip));
+        file_ << " into " << getInteger(opcode, ip) << endl;
+    }
+
+	void DumpOpcode::dumpIndex(const Opcode & opcode, size_t & ip)
+	{
+		dumpRegister(getRegister(opcode, ip));
+		file_ << " = ";
+		dumpRegister(getRegister(opcode, ip));
+		file_ << "[";
+		dumpRegister(getRegister(opcode, ip));
+		file_ << "]" << endl;
+	}
+
+	void DumpOpcode::dumpSetIndex(const Opcode & opcode, size_t & ip)
+	{
+		dumpRegister(getRegister(opcode, ip));
+		file_ << "[";
+		dumpRegister(getRegister(opcode, ip));
+		file_ << "] = ";
+		dumpRegister(getRegister(opcode, ip));
+		file_ << endl;
+	}
+
+    void DumpOpcode::dumpMove(const Opcode &opcode, size_t & ip)
+    {
+        dumpRegister(getRegister(opcode, ip));
+        file_ << " = ";
+        dumpRegister(getRegister(opcode, ip));
+        file_ << endl;
+    }
+
+    void DumpOpcode::dumpMoveF(const Opcode &opcode, size_t & ip)
+    {
+        dumpRegister(getRegister(opcode, ip));
+        file_ << " = " << getFloat(opcode, ip) << endl;
+    }
+
+    void DumpOpcode::dumpMoveI(const Opcode &opcode, size_t & ip)
+    {
+        dumpRegister(getRegister(opcode, ip));
+        file_ << " = " << getInteger(opcode, ip) << endl;
+    }
+
+    void DumpOpcode::dumpMoveL(const Opcode &opcode, size_t & ip)
+    {
+        dumpRegister(getRegister(opcode, ip));
+        uint64_t high = static_cast<uint32_t>(getInteger(opcode, ip));
+        uint64_t low = static_cast<uint32_t>(getInteger(opcode, ip));
+        file_ << " = " << static_cast<int64_t>((high << 32) | low) << endl;
+    }
+
+    void DumpOpcode::dumpMoveS(const Opcode &opcode, size_t & ip)
+    {
+        dumpRegister(getRegister(opcode, ip));
+        file_ << " = ";
+        file_ << "<string offset>:" << getInteger(opcode, ip);
+        file_ << endl;
+    }
+
+	void DumpOpcode::dumpMoveN(const Opcode & opcode, size_t & ip)
+	{
+		dumpRegister(getRegister(opcode, ip));
+		file_ << " = null";
+		file_ << endl;
+	}
+
+    void DumpOpcode::dumpHalt(const Opcode &opcode, size_t & ip)
+    {
+        file_ << "halt" << endl;
+    }
+
+    void DumpOpcode::dumpParam(const Opcode &opcode, size_t & ip)
+    {
+        file_ << "param ";
+        dumpRegister(getRegister(opcode, ip));
+        file_ << endl;
+    }
+
+    void DumpOpcode::dumpNewClosure(const Opcode &opcode, size_t & ip)
+    {
+		dumpRegister(getRegister(opcode, ip));
+		int32_t offset = getInteger(opcode, ip);
+		const std::string &name = module.getString(offset);
+		file_ << " = new closure : " << name;
+		file_ << " <params>:";
+		file_ << getInteger(opcode, ip) << endl;
+    }
+
+	void DumpOpcode::dumpUserClosure(const Opcode & opcode, size_t & ip)
+	{
+		dumpRegister(getRegister(opcode, ip));
+		int32_t offset = getInteger(opcode, ip);
+		const std::string &name = module.getString(offset);
+		file_ << " = new user closure : " << name << endl;
+	}
+
+    void DumpOpcode::dumpNewHash(const Opcode &opcode, size_t &ip)
+    {
+        dumpRegister(getRegister(opcode, ip));
+        file_ << " = new hash <array>:" << getInteger(opcode, ip);
+        file_ << " <hash>:" << getInteger(opcode, ip) << endl;
+    }
+    
+    void DumpOpcode::dumpRegister(unsigned reg)
+    {
+		file_ << "$" << reg;
+    }
+
+    void DumpOpcode::dumpStringPool()
+    {
+        file_ << "\n\n[String pool]: \n  size = " 
+			<< module.stringPool_.size() << endl;
+
+		for (size_t i = 0; i < module.stringPool_.size(); ++i) {
+			file_ << "\t" << i << " : " << module.stringPool_[i] << endl;
+		}
+    }
+
+    unsigned DumpOpcode::getRegister(const Opcode &opcode, size_t & ip)
+    {
+        unsigned result = (unsigned char)opcode[ip++];
+        result = (result << 8) | (unsigned char)opcode[ip++];
+        return result;
+    }
+
+    int32_t DumpOpcode::getInteger(const Opcode &opcode, size_t & ip)
+    {
+        int32_t result = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            result <<= 8; result |= (unsigned char)opcode[ip++];
+        }
+        return result;
+    }
+
+    double DumpOpcode::getFloat(const Opcode &opcode, size_t & ip)
+    {
+		uint64_t high = static_cast<uint32_t>(getInteger(opcode, ip));
+		uint64_t low = static_cast<uint32_t>(getInteger(opcode, ip));
+		uint64_t bits = (high << 32) | low;
+		double value;
+		memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+}
+
@@ -1,189 +1,427 @@
-#include "lib.h"
-
-#include <ctime>
-#include <iostream>
-#include <functional>
-
-#include "VM.h"
-#include "lexical_cast.h"
-
-using script::VMFrame;
-using script::VMState;
-using script::VMScene;
-
-struct Lib
-{
-	const char *name;
-	UserDefLibClosure closure;
-};
-
-static RequireCallback globalReguireCallback;
-
-static void DumpObject(Object object)
-{
-	if (IsFixnum(object))
-		std::cout << GetFixnum(object);
-	else if (IsString(object))
-		std::cout << StringGet(object);
-	else if (IsUserClosure(object))
-		std::cout << "User def<" << UserClosureGet(object) << ">";
-	else if (IsHash(object))
-		std::cout << "<hash>";
-	else if (IsCallable(object))
-		std::cout << "<closue>";
-	else
-		std::cout << "<object>";
-}
-
-Object lib_to_string(VMState *state, size_t paramsNums)
-{
-	if (paramsNums != 1) {
-		state->runtimeError("to_string only takes one parameter");
-	}
-	Object res = state->getScene()->paramsStack.back();
-	if (IsString(res))
-		return res;
-	else if (IsFixnum(res)) {
-		std::string str = std::to_string(GetFixnum(res));
-		Object result = state->getScene()->
-			GC.allocate(SizeOfString(str.length()));
-		return CreateString(result, str.c_str(), str.size());
-	}
-	else {
-		const char *str = "";
-		if (IsUserClosure(res))
-			str = "<user closure>";
-		else if (IsHash(res))
-			str = "<hash>";
-		else if (IsCallable(res))
-			str = "<closue>";
-		else
-			str = "<object>";
-		size_t length = strlen(str);
-		Object result = state->getScene()->
-			GC.allocate(SizeOfString(length));
-		return CreateString(result, str, length);
-	}
-}
-
-Object lib_to_integer(VMState *state, size_t paramsNums)
-{
-	if (paramsNums != 1) {
-		state->runtimeError("to_integer only takes one parameter");
-	}
-
-	Object res = state->getScene()->paramsStack.back();
-	if (IsString(res)) {
-		try {
-			int value = lexical_cast<int>(StringGet(res));
-			return CreateFixnum(value);
-		}
-		catch (const std::exception &e) {
-			return CreateNil();
-		}
-	}
-	else if (IsFixnum(res))
-		return res;
-	else
-		return CreateFixnum(1);
-}
-
-Object lib_is_null(VMState *state, size_t paramsNums)
-{
-	if (paramsNums != 1) {
-		state->runtimeError("is_null only takes one parameter");
-	}
-
-	Object res = state->getScene()->paramsStack.back();
-	return CreateFixnum(IsUndef(res) || IsNil(res));
-}
-
-Object lib_output(VMState * state, size_t paramsNums)
-{
-	VMScene *scene = state->getScene();
-	for (size_t idx = scene->paramsStack.size() - paramsNums;
-		idx < scene->paramsStack.size(); ++idx) {
-		Object arg = scene->paramsStack[idx];
-		DumpObject(arg);
-	}
-	return CreateNil();
-}
-
-Object lib_input(VMState * state, size_t paramsNums)
-{
-	lib_output(state, paramsNums);
-	std::string str;
-	std::cin >> str;
-	Object result = state->getScene()->
-		GC.allocate(SizeOfString(str.length()));
-	return CreateString(result, str.c_str(), str.size());
-}
-
-Object lib_println(VMState *state, size_t paramsNums)
-{
-	lib_output(state, paramsNums);
-	std::cout << std::endl;
-	return CreateNil();
-}
-
-Object lib_require(VMState *state, size_t paramsNums)
-{
-	assert(globalReguireCallback);
-	if (paramsNums != 1) {
-		state->runtimeError("require only takes one parameter");
-	}
-
-	Object res = state->getScene()->paramsStack.back();
-	if (IsString(res)) {
-		// save it.
-		std::string filename = StringGet(res); 
-		VMScene *scene = state->getScene();
-		unsigned resReg = static_cast<unsigned>(scene->lastValue);
-		globalReguireCallback(filename.c_str(), resReg);
-	}
-	return CreateUndef();
-}
-
-Object lib_random(VMState *state, size_t paramsNums) 
-{
-	if (paramsNums != 0) {
-		state->runtimeError("random no parameter");
-	}
-	return CreateFixnum(rand() % MAX_FIXNUM);
-}
-
-Object lib_time(VMState *state, size_t paramsNums)
-{
-	if (paramsNums != 0) {
-		state->runtimeError("time no parameter");
-	}
-
-	return CreateFixnum(clock());
-}
-
-static Lib libs[] = {
-	{ "output", lib_output },
-	{ "input", lib_input },
-	{ "println", lib_println },
-	{ "require", lib_require },
-	{ "random", lib_random },
-	{ "time", lib_time },
-	{ "is_null", lib_is_null },
-	{ "to_string", lib_to_string },
-	{ "to_integer", lib_to_integer },
-	{ nullptr, nullptr }
-};
-
-void RegisterLibrary(LibRegister lib_register)
-{
-	Lib *lib = libs;
-	while (lib->name) {
-		lib_register(lib->name, lib->closure);
-		lib++;
-	}
-}
-
-void RegisterRequire(RequireCallback require)
-{
-	globalReguireCallback = require;
-}
+#include "lib.h"
+
+#include <ctime>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <sstream>
+#include <iostream>
+#include <functional>
+
+#include "VM.h"
+
+using script::VMFrame;
+using script::VMState;
+using script::VMScene;
+using script::GCStats;
+
+struct Lib
+{
+	const char *name;
+	UserDefLibClosure closure;
+};
+
+static RequireCallback globalReguireCallback;
+
+static void DumpObject(Object object)
+{
+	if (IsFixnum(object))
+		std::cout << GetFixnum(object);
+	else if (IsReal(object))
+		std::cout << GetReal(object);
+	else if (IsString(object))
+		std::cout.write(StringGet(object), StringSize(object));
+	else if (IsUserClosure(object))
+		std::cout << "User def<" << UserClosureGet(object) << ">";
+	else if (IsHash(object))
+		std::cout << "<hash>";
+	else if (IsCallable(object))
+		std::cout << "<closue>";
+	else
+		std::cout << "<object>";
+}
+
+Object lib_to_string(VMState *state, const Object *args, size_t paramsNums)
+{
+	if (paramsNums != 1) {
+		state->runtimeError("to_string only takes one parameter");
+	}
+	Object res = args[0];
+	if (IsString(res))
+		return res;
+	else if (IsNumber(res)) {
+		std::ostringstream stream;
+		if (IsFixnum(res))
+			stream << GetFixnum(res);
+		else
+			stream << GetReal(res);
+		std::string str = stream.str();
+		Object result = state->getScene()->
+			GC.allocate(SizeOfString(str.length()));
+		return CreateString(result, str.c_str(), str.size());
+	}
+	else {
+		const char *str = "";
+		if (IsUserClosure(res))
+			str = "<user closure>";
+		else if (IsHash(res))
+			str = "<hash>";
+		else if (IsCallable(res))
+			str = "<closue>";
+		else
+			str = "<object>";
+		size_t length = strlen(str);
+		Object result = state->getScene()->
+			GC.allocate(SizeOfString(length));
+		return CreateString(result, str, length);
+	}
+}
+
+Object lib_to_integer(VMState *state, const Object *args, size_t paramsNums)
+{
+	if (paramsNums != 1) {
+		state->runtimeError("to_integer only takes one parameter");
+	}
+
+	Object res = args[0];
+	if (IsString(res)) {
+		// like atoi a string without digits reads as 0, values past
+		// the fixnum range come back as reals.
+		std::string str(StringGet(res), StringSize(res));
+		errno = 0;
+		long long value = std::strtoll(str.c_str(), nullptr, 10);
+		if (errno == ERANGE || value < MIN_FIXNUM || value > MAX_FIXNUM)
+			return CreateReal(std::strtod(str.c_str(), nullptr));
+		return CreateFixnum(static_cast<intptr_t>(value));
+	}
+	else if (IsFixnum(res))
+		return res;
+	else if (IsReal(res)) {
+		// reals without a fixnum of their own stay as they are.
+		double value = GetReal(res);
+		if (value >= (double)MIN_FIXNUM && value < -(double)MIN_FIXNUM)
+			return CreateFixnum(static_cast<intptr_t>(value));
+		return res;
+	}
+	else
+		return CreateFixnum(1);
+}
+
+Object lib_is_null(VMState *state, const Object *args, size_t paramsNums)
+{
+	if (paramsNums != 1) {
+		state->runtimeError("is_null only takes one parameter");
+	}
+
+	Object res = args[0];
+	return CreateFixnum(IsUndef(res) || IsNil(res));
+}
+
+Object lib_output(VMState *, const Object *args, size_t paramsNums)
+{
+	for (size_t idx = 0; idx < paramsNums; ++idx)
+		DumpObject(args[idx]);
+	return CreateNil();
+}
+
+Object lib_input(VMState *state, const Object *args, size_t paramsNums)
+{
+	lib_output(state, args, paramsNums);
+	std::string str;
+	std::cin >> str;
+	Object result = state->getScene()->
+		GC.allocate(SizeOfString(str.length()));
+	return CreateString(result, str.c_str(), str.size());
+}
+
+Object lib_println(VMState *state, const Object *args, size_t paramsNums)
+{
+	lib_output(state, args, paramsNums);
+	std::cout << std::endl;
+	return CreateNil();
+}
+
+Object lib_require(VMState *state, const Object *args, size_t paramsNums)
+{
+	assert(globalReguireCallback);
+	if (paramsNums != 1) {
+		state->runtimeError("require only takes one parameter");
+	}
+
+	Object res = args[0];
+	if (IsString(res)) {
+		// save it.
+		std::string filename(StringGet(res), StringSize(res)); 
+		VMScene *scene = state->getScene();
+		unsigned resReg = static_cast<unsigned>(scene->lastValue);
+		globalReguireCallback(filename.c_str(), resReg);
+	}
+	return CreateUndef();
+}
+
+Object lib_random(VMState *state, const Object *, size_t paramsNums) 
+{
+	if (paramsNums != 0) {
+		state->runtimeError("random no parameter");
+	}
+	return CreateFixnum(rand() % MAX_FIXNUM);
+}
+
+Object lib_time(VMState *state, const Object *, size_t paramsNums)
+{
+	if (paramsNums != 0) {
+		state->runtimeError("time no parameter");
+	}
+
+	return CreateFixnum(clock());
+}
+
+Object lib_len(VMState *state, const Object *args, size_t paramsNums)
+{
+	if (paramsNums != 1) {
+		state->runtimeError("len only takes one parameter");
+	}
+	if (IsHash(args[0]))
+		return CreateFixnum(HashSize(args[0]));
+	else if (IsString(args[0]))
+		return CreateFixnum(StringSize(args[0]));
+	state->runtimeError("len takes a table or string");
+	return CreateNil();
+}
+
+//
+// substr(s, start, length) shares the bytes of s unless short, 
+// length defaults to the rest of s.
+Object lib_substr(VMState *state, const Object *args, size_t paramsNums)
+{
+	if (paramsNums < 2 || paramsNums > 3 || !IsString(args[0])
+		|| !IsFixnum(args[1]) || (paramsNums == 3 && !IsFixnum(args[2]))) {
+		state->runtimeError("substr takes a string, start and length");
+	}
+	intptr_t size = StringSize(args[0]);
+	intptr_t start = std::min(std::max(GetFixnum(args[1]), 
+		(intptr_t)0), size);
+	intptr_t length = paramsNums == 3 ? GetFixnum(args[2]) : size;
+	length = std::min(std::max(length, (intptr_t)0), size - start);
+	return StringSubstr(args[0], start, length);
+}
+
+// find(s, pattern, start) is the offset of pattern in s, or -1.
+Object lib_find(VMState *state, const Object *args, size_t paramsNums)
+{
+	if (paramsNums < 2 || paramsNums > 3 || !IsString(args[0])
+		|| !IsString(args[1]) || (paramsNums == 3 && !IsFixnum(args[2]))) {
+		state->runtimeError("find takes a string, pattern and start");
+	}
+	const char *str = StringGet(args[0]), *end = str + StringSize(args[0]);
+	const char *pattern = StringGet(args[1]);
+	intptr_t start = paramsNums == 3 ? GetFixnum(args[2]) : 0;
+	start = std::min(std::max(start, (intptr_t)0), end - str);
+	const char *found = std::search(str + start, end, 
+		pattern, pattern + StringSize(args[1]));
+	if (found == end && StringSize(args[1]) != 0)
+		return CreateFixnum(-1);
+	return CreateFixnum(found - str);
+}
+
+//
+// join(t, sep) concatenates the strings in t in iteration order, 
+// the result is sized once and each piece copied once.
+Object lib_join(VMState *state, const Object *args, size_t paramsNums)
+{
+	if (paramsNums != 2 || !IsHash(args[0]) || !IsString(args[1])) {
+		state->runtimeError("join takes a table and a separator");
+	}
+
+	size_t length = 0, count = 0;
+	for (intptr_t cursor = HashNextCursor(args[0], -1); cursor >= 0;
+		cursor = HashNextCursor(args[0], cursor)) {
+		Object value = HashCursorValue(args[0], cursor);
+		if (!IsString(value))
+			state->runtimeError("join takes a table of strings");
+		length += StringSize(value);
+		count++;
+	}
+	if (count > 1)
+		length += (count - 1) * StringSize(args[1]);
+
+	// args may move while the result is allocated.
+	Object result = state->getScene()->GC.allocate(SizeOfString(length));
+	CreateString(result, nullptr, length);
+	char *str = const_cast<char*>(StringGet(result));
+	size_t offset = 0;
+	bool first = true;
+	for (intptr_t cursor = HashNextCursor(args[0], -1); cursor >= 0;
+		cursor = HashNextCursor(args[0], cursor), first = false) {
+		if (!first) {
+			memcpy(str + offset, StringGet(args[1]), StringSize(args[1]));
+			offset += StringSize(args[1]);
+		}
+		Object value = HashCursorValue(args[0], cursor);
+		memcpy(str + offset, StringGet(value), StringSize(value));
+		offset += StringSize(value);
+	}
+	return result;
+}
+
+typedef Object(*CursorGetter)(Object, intptr_t);
+
+//
+// a new table holding, at 0..n-1, what get returns for every entry.
+static Object CollectEntries(VMState *state, const Object *args, 
+	size_t paramsNums, CursorGetter get)
+{
+	if (paramsNums != 1 || !IsHash(args[0])) {
+		state->runtimeError("only takes one table");
+	}
+
+	// args may move while the result is allocated.
+	size_t size = HashSize(args[0]);
+	Object result = CreateSizedHash(size, 0);
+	Object table = args[0];
+	intptr_t idx = 0;
+	for (intptr_t cursor = HashNextCursor(table, -1); cursor >= 0;
+		cursor = HashNextCursor(table, cursor)) {
+		HashSetAndUpdate(result, CreateFixnum(idx++), get(table, cursor));
+	}
+	return result;
+}
+
+Object lib_keys(VMState *state, const Object *args, size_t paramsNums)
+{
+	return CollectEntries(state, args, paramsNums, HashCursorKey);
+}
+
+Object lib_values(VMState *state, const Object *args, size_t paramsNums)
+{
+	return CollectEntries(state, args, paramsNums, HashCursorValue);
+}
+
+//
+// next(table, cursor) is the cursor of the entry after cursor, or -1
+// past the last one, start from -1. Not nil, the first cursor may be
+// 0 which equals nil. key_at and value_at read the entry, cursors 
+// stay valid until the table is resized.
+Object lib_next(VMState *state, const Object *args, size_t paramsNums)
+{
+	if (paramsNums != 2 || !IsHash(args[0]) || !IsFixnum(args[1])) {
+		state->runtimeError("next takes a table and a cursor");
+	}
+	return CreateFixnum(HashNextCursor(args[0], GetFixnum(args[1])));
+}
+
+Object lib_key_at(VMState *state, const Object *args, size_t paramsNums)
+{
+	if (paramsNums != 2 || !IsHash(args[0]) || !IsFixnum(args[1])) {
+		state->runtimeError("key_at takes a table and a cursor");
+	}
+	return HashCursorKey(args[0], GetFixnum(args[1]));
+}
+
+Object lib_value_at(VMState *state, const Object *args, size_t paramsNums)
+{
+	if (paramsNums != 2 || !IsHash(args[0]) || !IsFixnum(args[1])) {
+		state->runtimeError("value_at takes a table and a cursor");
+	}
+	return HashCursorValue(args[0], GetFixnum(args[1]));
+}
+
+// drops the room left by removed keys.
+Object lib_compact(VMState *state, const Object *args, size_t paramsNums)
+{
+	if (paramsNums != 1 || !IsHash(args[0])) {
+		state->runtimeError("compact only takes one table");
+	}
+	HashCompact(args[0]);
+	return CreateNil();
+}
+
+// the table being filled is kept on top of the value stack, which 
+// is scanned by gc, as allocating keys may move it.
+static void SetStatistic(VMScene *scene, const char *name, intptr_t value)
+{
+	size_t length = strlen(name);
+	Object key = scene->GC.allocate(SizeOfString(length));
+	CreateString(key, name, length);
+	HashSetAndUpdate(scene->stack.back(), key, CreateFixnum(value));
+}
+
+Object lib_gc_stats(VMState *state, const Object *, size_t paramsNums)
+{
+	if (paramsNums != 0) {
+		state->runtimeError("gc_stats no parameter");
+	}
+
+	VMScene *scene = state->getScene();
+	const GCStats &stats = scene->GC.stats();
+	scene->stack.push_back(CreateHash());
+	SetStatistic(scene, "minor_collections", stats.minorCollections);
+	SetStatistic(scene, "major_collections", stats.majorCollections);
+	SetStatistic(scene, "pause_total_us", stats.totalPause);
+	SetStatistic(scene, "pause_max_us", stats.maxPause);
+	SetStatistic(scene, "pause_last_us", stats.lastPause);
+	SetStatistic(scene, "allocated_kb", stats.bytesAllocated >> 10);
+	SetStatistic(scene, "copied_kb", stats.bytesCopied >> 10);
+	SetStatistic(scene, "survival_percent", stats.lastSurvival * 100);
+	SetStatistic(scene, "heap_kb", scene->GC.heapSize() >> 10);
+	Object result = scene->stack.back();
+	scene->stack.pop_back();
+	return result;
+}
+
+// bytes of live objects keyed by type name.
+Object lib_gc_histogram(VMState *state, const Object *, size_t paramsNums)
+{
+	if (paramsNums != 0) {
+		state->runtimeError("gc_histogram no parameter");
+	}
+
+	VMScene *scene = state->getScene();
+	auto histogram = scene->GC.liveHistogram();
+	scene->stack.push_back(CreateHash());
+	for (auto &usage : histogram)
+		SetStatistic(scene, usage.name, usage.bytes);
+	Object result = scene->stack.back();
+	scene->stack.pop_back();
+	return result;
+}
+
+static Lib libs[] = {
+	{ "output", lib_output },
+	{ "input", lib_input },
+	{ "println", lib_println },
+	{ "require", lib_require },
+	{ "random", lib_random },
+	{ "time", lib_time },
+	{ "is_null", lib_is_null },
+	{ "to_string", lib_to_string },
+	{ "to_integer", lib_to_integer },
+	{ "gc_stats", lib_gc_stats },
+	{ "gc_histogram", lib_gc_histogram },
+	{ "compact", lib_compact },
+	{ "len", lib_len },
+	{ "substr", lib_substr },
+	{ "find", lib_find },
+	{ "join", lib_join },
+	{ "keys", lib_keys },
+	{ "values", lib_values },
+	{ "next", lib_next },
+	{ "key_at", lib_key_at },
+	{ "value_at", lib_value_at },
+	{ nullptr, nullptr }
+};
+
+void RegisterLibrary(LibRegister lib_register)
+{
+	Lib *lib = libs;
+	while (lib->name) {
+		lib_register(lib->name, lib->closure);
+		lib++;
+	}
+}
+
+void RegisterRequire(RequireCallback require)
+{
+	globalReguireCallback = require;
+}
@@ -1,16 +1,18 @@
-#pragma once
-
-#include <functional>
-
-#include "Runtime.h"
-
-namespace script {
-	class VMState;
-}
-
-typedef Object(*UserDefLibClosure)(script::VMState*, size_t);
-typedef std::function<void(const char *, UserDefLibClosure)> LibRegister;
-typedef std::function<void(const char*, unsigned)> RequireCallback;
-void RegisterLibrary(LibRegister lib_register);
-void RegisterRequire(RequireCallback require);
-
+#pragma once
+
+#include <functional>
+
+#include "Runtime.h"
+
+namespace script {
+	class VMState;
+}
+
+// args stay valid until the closure allocates or re-enters the vm.
+typedef Object(*UserDefLibClosure)(
+	script::VMState*, const Object *args, size_t);
+typedef std::function<void(const char *, UserDefLibClosure)> LibRegister;
+typedef std::function<void(const char*, unsigned)> RequireCallback;
+void RegisterLibrary(LibRegister lib_register);
+void RegisterRequire(RequireCallback require);
+
@@ -1,66 +1,116 @@
-#ifndef __OPCODE_H__
-#define __OPCODE_H__
-
-#include <functional>
-#include <string>
-#include <map>
-#include <list>
-#include <vector>
-#include <memory>
-
-#include "Runtime.h"
-
-namespace script
-{
-	typedef int8_t Byte;
-
-    enum Opcode {
-        OK_Goto = 0,    // goto lable@_addr
-
-        // operator
-        // single 
-        OK_Not,         // temp = !temp
-        // binary 
-        OK_Add,         // temp = temp + temp
-        OK_Sub,         // temp = temp - temp
-        OK_Mul,         // temp = temp * temp
-        OK_Div,         // temp = temp / temp
-        // relop
-        OK_Great,       // temp = temp > temp
-        OK_GreatThan,   // temp = temp >= temp
-        OK_Less,        // temp = temp < temp
-        OK_LessThan,    // temp = temp <= temp
-        OK_Equal,       // temp = temp == temp
-        OK_NotEqual,    // temp = temp != temp
-
-        // move
-        OK_MoveS,       // temp = string index
-        OK_MoveI,       // temp = constant
-        OK_MoveF,		// temp = float
-		OK_MoveN,		// temp = null
-        OK_Move,        // temp = temp
-
-        // memory
-        OK_Load,        // load id to temp
-        OK_Index,       // load id [ temp ] to temp
-        OK_Store,       // store id from temp
-        OK_SetIndex,      // store id [ temp ] from temp
-
-        // condition jmp
-        OK_If,          // if temp goto label
-
-        // call 
-        OK_Param,       // push temp
-        OK_Call,        // temp = call Label in num params
-        OK_TailCall,
-        OK_Return,      // return temp
-		OK_NewHash,		// tmp = new hash
-		OK_NewClosure,	// tmp = new string(idx)
-		OK_UserClosure, // tmp = new user closure
-        OK_Halt,        // stop
-    };
-    
-}
-
-#endif // !__OPCODE_H__
-
+#ifndef __OPCODE_H__
+#define __OPCODE_H__
+
+#include <functional>
+#include <string>
+#include <map>
+#include <list>
+#include <vector>
+#include <memory>
+
+#include "Runtime.h"
+
+namespace script
+{
+	typedef int8_t Byte;
+
+	// register operands are encoded in 16 bits.
+	const unsigned RegisterLimit = 0x10000;
+
+    enum Opcode {
+        OK_Goto = 0,    // goto lable@_addr
+
+        // operator
+        // single 
+        OK_Not,         // temp = !temp
+        // binary 
+        OK_Add,         // temp = temp + temp
+        OK_Sub,         // temp = temp - temp
+        OK_Mul,         // temp = temp * temp
+        OK_Div,         // temp = temp / temp
+        // relop
+        OK_Great,       // temp = temp > temp
+        OK_GreatThan,   // temp = temp >= temp
+        OK_Less,        // temp = temp < temp
+        OK_LessThan,    // temp = temp <= temp
+        OK_Equal,       // temp = temp == temp
+        OK_NotEqual,    // temp = temp != temp
+		// relop and +, - with a 32 bits constant right operand
+		OK_AddImm,		// temp = temp + constant
+		OK_SubImm,		// temp = temp - constant
+		OK_GreatImm,	// temp = temp > constant
+		OK_GreatThanImm,	// temp = temp >= constant
+		OK_LessImm,		// temp = temp < constant
+		OK_LessThanImm,	// temp = temp <= constant
+		OK_EqualImm,	// temp = temp == constant
+		OK_NotEqualImm,	// temp = temp != constant
+
+        // move
+        OK_MoveS,       // temp = string index
+        OK_MoveI,       // temp = constant
+        OK_MoveL,       // temp = 64 bits constant
+        OK_MoveF,		// temp = double
+		OK_MoveN,		// temp = null
+        OK_Move,        // temp = temp
+
+        // memory
+        OK_Load,        // load id to temp
+        OK_Index,       // load id [ temp ] to temp
+        OK_Store,       // store id from temp
+        OK_SetIndex,      // store id [ temp ] from temp
+
+        // condition jmp
+        OK_If,          // if temp goto label
+		OK_JumpIfGreat,			// if temp > temp goto label
+		OK_JumpIfGreatThan,		// if temp >= temp goto label
+		OK_JumpIfLess,			// if temp < temp goto label
+		OK_JumpIfLessThan,		// if temp <= temp goto label
+		OK_JumpIfEqual,			// if temp == temp goto label
+		OK_JumpIfNotEqual,		// if temp != temp goto label
+		OK_JumpUnlessGreat,		// if !(temp > temp) goto label
+		OK_JumpUnlessGreatThan,	// if !(temp >= temp) goto label
+		OK_JumpUnlessLess,		// if !(temp < temp) goto label
+		OK_JumpUnlessLessThan,	// if !(temp <= temp) goto label
+
+        // call 
+        OK_Param,       // push temp
+        OK_Call,        // temp = call Label in num params
+        OK_TailCall,
+        OK_Return,      // return temp
+        OK_ReturnN,     // return null
+		OK_NewHash,		// tmp = new hash <array size> <hash size>
+		OK_NewClosure,	// tmp = new string(idx)
+		OK_UserClosure, // tmp = new user closure
+        OK_Halt,        // stop
+
+		// Quickened forms, only produced in the decoded stream. They
+		// assume fixnum operands and rewrite themselves back to the
+		// generic opcode when that doesn't hold.
+		OK_AddII,
+		OK_SubII,
+		OK_GreatII,
+		OK_GreatThanII,
+		OK_LessII,
+		OK_LessThanII,
+		OK_EqualII,
+		OK_NotEqualII,
+    };
+
+	//
+	// Fixed width, native endian form of an instruction, built from
+	// the byte stream by OpDecoder when a module is loaded.
+	// Jump targets are instruction indices.
+	struct DecodedInstr
+	{
+		uint16_t op;
+		uint16_t a;
+		uint16_t b;
+		uint16_t c;
+		int32_t imm;
+		int32_t ext;
+	};
+    
+}
+
+#endif // !__OPCODE_H__
+
@@ -0,0 +1,24 @@
+#!/bin/sh
+#
+# run every script in unittest/scripts with and without -o and
+# compare what it prints with the .expect file next to it. Extra
+# arguments for a script go in a .flags file next to it.
+#
+cd "$(dirname "$0")/.."
+main=${1:-./target/main}
+failures=0
+
+for script in unittest/scripts/*.ll; do
+	expect="${script%.ll}.expect"
+	extra=$(cat "${script%.ll}.flags" 2>/dev/null)
+	for flags in "" "-o"; do
+		if ! $main $flags $extra "$script" < /dev/null 2>&1 \
+			| diff -u "$expect" - > /dev/null; then
+			echo "FAIL: $script $flags"
+			failures=$((failures + 1))
+		fi
+	done
+done
+
+echo "$failures failure(s)"
+[ $failures -eq 0 ]
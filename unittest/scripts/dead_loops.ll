@@ -0,0 +1,8 @@
+# constant branches guarding whole loops leave dead blocks which
+# are each other's successors.
+let a = 1;
+if (0) { while (a < 3) { a = a + 1; } }
+output(a, "\n");
+let b = 1;
+if (1) { b = 7; } else { while (b < 3) { b = b + 1; } }
+output(b, "\n");
@@ -0,0 +1,2 @@
+# a main without registers once optimized.
+let v2 = 3;
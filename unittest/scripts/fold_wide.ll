@@ -0,0 +1,8 @@
+# int arithmetic folds as long as operands and result are fixnums.
+let a = 3000000000 + 3000000000;
+let b = 2305843009213693951 + 1;
+let c = 3037000500 * 3037000500;
+let d = 0 - 2305843009213693951 - 1;
+let e = d - 1;
+output(a, " ", b, " ", c, "\n");
+output(d, " ", e, " ", 9000000000 / 3, "\n");
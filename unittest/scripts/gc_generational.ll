@@ -0,0 +1,63 @@
+# runs with an 8K heap, see gc_generational.flags. The nursery is 2K
+# and objects over 512 bytes are pretenured into the old space.
+
+# tables this big live in the old space, stores of young values into
+# the array part and the hash part go through the write barrier.
+let t = [];
+let i = 0;
+while (i < 300) {
+	t[i] = "v" + to_string(i);
+	t["k" + to_string(i)] = i;
+	i = i + 1;
+}
+let round = 1;
+while (round < 4) {
+	i = 0;
+	while (i < 300) {
+		t[i] = to_string(i * round);
+		t["k" + to_string(i)] = [ x = i + round ];
+		i = i + 1;
+	}
+	round = round + 1;
+}
+let sum = 0;
+i = 0;
+while (i < 300) {
+	sum = sum + to_integer(t[i]) + t["k" + to_string(i)]["x"];
+	i = i + 1;
+}
+output(len(t), " ", sum, "\n");
+
+# a young table reached from two old tables is moved once, both see
+# the same object afterwards.
+let shared = [ n = 0 ];
+let u = [];
+i = 0;
+while (i < 300) { u[i] = i; i = i + 1; }
+t[7] = shared;
+u[7] = shared;
+i = 0;
+while (i < 2000) { shared["n"] = shared["n"] + 1; t["g"] = to_string(i); i = i + 1; }
+t[7]["n"] = t[7]["n"] + 1;
+output(u[7]["n"], " ", shared["n"], "\n");
+
+# closures with this many params are pretenured, every partial
+# application stores a young string into an old closure.
+function wide(a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34, a35, a36, a37, a38, a39, a40, a41, a42, a43, a44, a45, a46, a47, a48, a49, a50, a51, a52, a53, a54, a55, a56, a57, a58, a59, a60, a61, a62, a63) {
+	return a0 + a1 + a31 + a62 + a63;
+}
+let f = wide;
+i = 0;
+while (i < 64) {
+	f = f("p" + to_string(i) + " ");
+	i = i + 1;
+}
+output(f, "\n");
+
+# the live set outgrows the initial heap, which grows to hold it.
+let keep = [];
+i = 0;
+while (i < 5000) { keep[i] = "item" + to_string(i); i = i + 1; }
+let stats = gc_stats();
+output(keep[4999], " ", stats["heap_kb"] > 8, " ", 
+	stats["minor_collections"] > 0, " ", stats["major_collections"] > 0, "\n");
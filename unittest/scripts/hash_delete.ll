@@ -0,0 +1,53 @@
+# storing null deletes, the slot is left as a tombstone.
+let t = [];
+let i = 0;
+while (i < 200) { t["k" + to_string(i)] = i; i = i + 1; }
+i = 0;
+while (i < 200) { t["k" + to_string(i)] = null; i = i + 2; }
+let sum = 0;
+i = 1;
+while (i < 200) { sum = sum + t["k" + to_string(i)]; i = i + 2; }
+output(len(t), " ", sum, " ", is_null(t["k0"]), "\n");
+
+# reinsertion finds the key again past the tombstones.
+i = 0;
+while (i < 200) { t["k" + to_string(i)] = 1000 + i; i = i + 2; }
+output(len(t), " ", t["k0"], " ", t["k198"], " ", t["k199"], "\n");
+
+# insert and delete churn fills the table with tombstones only.
+i = 0;
+while (i < 5000) {
+	let key = "c" + to_string(i);
+	t[key] = i;
+	t[key] = null;
+	i = i + 1;
+}
+let n = 0;
+let c = next(t, -1);
+while (c != -1) { n = n + 1; c = next(t, c); }
+output(len(t), " ", n, " ", t["k77"], " ", is_null(t["c4999"]), "\n");
+
+# growth past several capacities, keys outside the array part
+# (storing to -1 appends, so they start at -2).
+let g = [];
+i = 0;
+while (i < 20000) { g[0 - 2 - i] = i; i = i + 1; }
+sum = 0;
+i = 0;
+while (i < 20000) { sum = sum + g[0 - 2 - i]; i = i + 1; }
+output(len(g), " ", sum, "\n");
+
+# deleting most of it and compacting keeps the rest.
+i = 0;
+let m = 0;
+while (i < 20000) {
+	if (m != 0) { g[0 - 2 - i] = null; }
+	m = m + 1;
+	if (m == 100) { m = 0; }
+	i = i + 1;
+}
+compact(g);
+sum = 0;
+i = 0;
+while (i < 20000) { sum = sum + g[0 - 2 - i]; i = i + 100; }
+output(len(g), " ", sum, " ", is_null(g[0 - 3]), "\n");
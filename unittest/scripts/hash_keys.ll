@@ -0,0 +1,29 @@
+# string keys hash by content, a slice finds the flat string's entry.
+let long = "0123456789abcdefghijklmnopqrstuvwxyz";
+let flat = "456789abcdefghijklmnopqrstuvwxyz0123";
+let t = [];
+t[flat] = "flat";
+let slice = substr(long + long, 4, 36);
+output(len(slice), " ", slice == flat, " ", t[slice], "\n");
+t[slice] = "slice";
+output(len(t), " ", t[flat], " ", is_null(t["ab" + "c"]), "\n");
+
+# many short keys share control bytes and probe past each other.
+let i = 0;
+while (i < 600) { t["k" + to_string(i)] = i; i = i + 1; }
+let sum = 0;
+i = 0;
+while (i < 600) { sum = sum + t["k" + to_string(i)]; i = i + 1; }
+output(len(t), " ", sum, " ", is_null(t["k600"]), "\n");
+
+# an int valued real is the same key as the int, others are not.
+let r = [];
+r[2] = "int";
+output(r[2.0], " ");
+r[2.0] = "real";
+r[2.5] = "half";
+r[3000000000.0] = "wide";
+output(r[2], " ", r[2.5], " ", r[3000000000], " ", len(r), "\n");
+let big = 100000000000000000000.0;
+r[big] = "boxed";
+output(r[big * 1.0], " ", is_null(r[0 - 1]), " ", len(r), "\n");
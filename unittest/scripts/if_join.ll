@@ -0,0 +1,40 @@
+# a variable written inside an if must reach the join block, also
+# when the then part holds a loop of its own.
+function sum_above(n, limit) {
+  let s = 0;
+  let i = 0;
+  while (i < n) {
+    if (i > limit) {
+      s = s + i;
+    }
+    i = i + 1;
+  }
+  return s;
+}
+output(sum_above(10, 4), "\n");
+
+function keep(x) {
+  let s = 0;
+  if (x > 4) {
+    s = s + x;
+  }
+  return s;
+}
+output(keep(5), " ", keep(1), "\n");
+
+function nested(n) {
+  let v = 1;
+  let i = 0;
+  while (i < n) {
+    i = i + 1;
+    if (v <= 3) {
+      v = v + 2;
+      let j = 0;
+      while (j < 4) {
+        j = j + 1;
+      }
+    }
+  }
+  return v;
+}
+output(nested(2), " ", nested(0), "\n");
@@ -0,0 +1,21 @@
+# small integer constants are immediates of +, - and compares, other
+# operands than fixnums take the generic path with the same constant.
+function f(x) {
+	let a = x + 1;
+	let b = x - 2;
+	let c = x < 3;
+	let d = x >= 3;
+	let e = x == 4;
+	let g = x != 4;
+	output(a, " ", b, " ", c, " ", d, " ", e, " ", g, "\n");
+}
+f(4);
+f(1.5);
+f(4.0);
+f(2305843009213693951);
+let s = "a";
+output(s == 1, " ", s != 1, "\n");
+let i = 0;
+let n = 0;
+while (i < 10) { n = n + 3; i = i + 1; }
+output(n, " ", n - 100, "\n");
@@ -0,0 +1,16 @@
+# reals outside the tagged range are boxed instead of clamped.
+let a = 1.0;
+let i = 0;
+while (i < 101) { a = a * 10.0; i = i + 1; }
+let b = 1.0;
+i = 0;
+while (i < 270) { b = b / 10.0; i = i + 1; }
+output(a, " ", b, " ", 0.0 - a, "\n");
+output(a > 1.0, " ", b > 0.0, " ", b * 1.0 == b, "\n");
+
+# boxed reals are keys by value and survive collections.
+let t = [];
+t[a] = "big";
+i = 0;
+while (i < 20000) { t[i] = b * i; i = i + 1; }
+output(t[a * 1.0], " ", t[19999] / b, "\n");
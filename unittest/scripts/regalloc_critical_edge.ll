@@ -0,0 +1,17 @@
+# the loop body branches straight to the join, the phi copies on that
+# edge go to a block of their own.
+function pick(n, x, y, z) {
+  let a = 4;
+  let r = 8;
+  let i = 0;
+  while (i < n) {
+    i = i + 1;
+    r = a;
+    if (x <= y) {
+      r = z;
+    }
+    a = r + 1;
+  }
+  return a * 100 + r;
+}
+output(pick(2, 5, 4, 2), " ", pick(2, 4, 5, 2), "\n");
@@ -0,0 +1,29 @@
+# nested loops carry several phis per header.
+function triangle(n) {
+  let total = 0;
+  let i = 0;
+  while (i < n) {
+    let j = 0;
+    while (j < i) {
+      total = total + j;
+      j = j + 1;
+    }
+    i = i + 1;
+  }
+  return total;
+}
+output(triangle(10), " ", triangle(0), "\n");
+
+function fib(n) {
+  let a = 0;
+  let b = 1;
+  let k = 0;
+  while (k < n) {
+    let t = a + b;
+    a = b;
+    b = t;
+    k = k + 1;
+  }
+  return a;
+}
+output(fib(20), " ", fib(1), "\n");
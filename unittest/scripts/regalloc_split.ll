@@ -0,0 +1,15 @@
+# a value defined in the hole of another interval outlives the hole,
+# so its own interval is split.
+function f(x, y) {
+  if (y == y) {
+    y = x - y;
+    y = y - y;
+    y = y + x;
+  }
+  y = x + y;
+  let z = y - y;
+  output(y, " ");
+  return y;
+}
+output(f(-3, 5), "\n");
+output(f(4, 1), "\n");
@@ -0,0 +1,25 @@
+# the else part trades a and c on its way to the join, those copies
+# form a cycle and one value is parked in the scratch register.
+function rotate(n) {
+  let a = 9;
+  let b = 8;
+  let c = 2;
+  let i = 0;
+  while (i < n) {
+    i = i + 1;
+    a = b;
+    if (c > a) {
+      let t = a;
+      a = b;
+    } else {
+      let u = a;
+      a = c;
+      c = b;
+    }
+    b = a - 2;
+  }
+  a = b - c;
+  output(a, " ", b, " ", c, "\n");
+}
+rotate(3);
+rotate(0);
@@ -0,0 +1,6 @@
+# functions without a return value, dead code elimination may leave
+# them without any register.
+function f(x) { let y = x + 1; }
+function g() { }
+output(is_null(f(1)), " ", is_null(g()), "\n");
+let v = 3;
@@ -0,0 +1,33 @@
+# a + "X" appends in place to the buffer behind a, a second append to
+# a must copy instead of overwriting the first one.
+let a = "0123456789abcdefghij" + "klmnopqrstuvwxyz";
+let b = a + "X";
+let c = a + "Y";
+output(len(a), " ", a, "\n");
+output(b, "\n", c, "\n");
+output(a == b, " ", b == c, " ", substr(b, 30) + substr(c, 36), "\n");
+
+# chains of appends keep every intermediate result intact.
+let s = a;
+let t = [];
+let i = 0;
+while (i < 40) { s = s + to_string(i); t[i] = s; i = i + 1; }
+output(len(s), " ", len(t[0]), " ", len(t[10]), " ", substr(t[10], 36), "\n");
+
+# slices of appended buffers see only their own bytes, tail ends
+# where b does so d is appended in place behind both.
+let tail = substr(b, 4);
+let d = tail + "Z";
+output(tail, " ", find(b, "X"), " ", find(tail, "X"), " ", find(tail, "Z"), "\n");
+output(find(d, "Z"), " ", find(b, "Z"), " ", len(b), " ", find(s, "3839"), "\n");
+output(to_integer(substr(s, 36, 2)) + 1, " ", to_integer(substr(s, 36 + 10, 4)), "\n");
+
+# join copies each piece once, pieces may be slices of one buffer.
+let parts = [ b, c ];
+parts[2] = substr(s, 36, 10);
+parts[3] = "";
+let j = join(parts, ",");
+output(len(j), " ", j, "\n");
+let one = [ a ];
+let none = [];
+output(join(one, "-") == a, " ", join(none, ","), ".\n");
@@ -0,0 +1,13 @@
+# cursors run from -1 back to -1, the first one may be 0.
+let t = [ a = 1, b = 2, ];
+t[0] = "z0";
+let c = next(t, -1);
+let n = 0;
+while (c != -1) {
+  output(key_at(t, c), "=", value_at(t, c), " ");
+  n = n + 1;
+  c = next(t, c);
+}
+output(n, "\n");
+let e = [ ];
+output(next(e, -1), "\n");
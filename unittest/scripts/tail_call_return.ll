@@ -0,0 +1,9 @@
+# a tail call which does not take over the frame must still return.
+function f(x) { return to_string(x); }
+function g(a, b) { return a + b; }
+function h(x) { return g(x); }
+
+let r = f(5);
+output("r=", r, "\n");
+let p = h(1);
+output("p=", p(2), "\n");
@@ -0,0 +1,3 @@
+# to_integer keeps 62-bit values and leaves out of range ones as reals.
+output(to_integer("5000000000"), " ", to_integer("-42"), " ", to_integer("abc"), "\n");
+output(to_integer("99999999999999999999"), " ", to_integer(1000000000000000000000000000.0), " ", to_integer(0 - 3.7), "\n");
@@ -0,0 +1,12 @@
+# integer literals are 64 bits, the ones past the fixnum range
+# become reals like fixnum arithmetic does.
+let big = 5000000000;
+output(big, " ", big + 1, " ", 0 - big, " ", big * 2, "\n");
+output(2305843009213693951, " ", 2305843009213693952, "\n");
+output(99999999999999999999 > 1, "\n");
+let i = 0;
+let s = 0;
+while (i < 3) { s = s + 3000000000; i = i + 1; }
+output(s, " ", s == 9000000000, "\n");
+let t = [ 5000000000 = "wide", ];
+output(t[big], "\n");